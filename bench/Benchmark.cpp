@@ -0,0 +1,107 @@
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+#include "Benchmark.h"
+
+// The build type is defined by CMake
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+	/**
+	 * Returns the given text as a JSON string literal.
+	 *
+	 * @param text The text
+	 * @return The quoted and escaped text
+	 */
+	std::string quote(const std::string &text) {
+		std::string quoted = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\') quoted += '\\';
+			quoted += c;
+		}
+		return quoted + "\"";
+	}
+}
+
+Benchmark::Benchmark(const std::string &filter, double minTime) :
+		filter(filter), minTime(minTime) {
+
+}
+
+bool Benchmark::isSelected(const std::string &name) const {
+	return name.find(filter) != std::string::npos;
+}
+
+void Benchmark::run(const std::string &name, const Task &task, double items, double bytes) {
+	if (!isSelected(name)) return;
+
+	// Like Google Benchmark, the iterations are scaled by the measured time (at most 10x at a time)
+	// The CPU time is the process' CPU time, so it includes the simulator's worker threads
+	unsigned long iterations = 1;
+	double seconds;
+	double cpuSeconds;
+	while (true) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::clock_t cpuStart = std::clock();
+		task(iterations);
+		cpuSeconds = (double) (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+		seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (seconds >= minTime) break;
+
+		double scale = seconds > 0 ? 1.4 * minTime / seconds : 10;
+		iterations = std::max(iterations + 1, (unsigned long) (iterations * std::min(scale, 10.0)));
+	}
+
+	results.push_back({name, iterations, seconds, cpuSeconds, items, bytes});
+	std::cerr << std::left << std::setw(40) << name << std::right
+	          << std::setw(14) << std::fixed << std::setprecision(0) << seconds / iterations * 1e9 << " ns"
+	          << std::setw(12) << iterations;
+	if (items > 0) std::cerr << std::setw(14) << std::setprecision(3) << items * iterations / seconds / 1e6 << " M items/s";
+	if (bytes > 0) std::cerr << std::setw(14) << std::setprecision(3) << bytes * iterations / seconds / 1e6 << " MB/s";
+	std::cerr << std::endl;
+}
+
+void Benchmark::printJson(std::ostream &out, unsigned long threads) const {
+	char date[32];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	out << std::setprecision(10);
+	out << "{" << std::endl;
+	out << "  \"context\": {" << std::endl;
+	out << "    \"date\": " << quote(date) << "," << std::endl;
+	out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl;
+	out << "    \"simulator_threads\": " << threads << "," << std::endl;
+	out << "    \"library_build_type\": " << quote(BENCH_BUILD_TYPE) << std::endl;
+	out << "  }," << std::endl;
+	out << "  \"benchmarks\": [";
+	for (unsigned long i = 0; i < results.size(); i++) {
+		const Result &result = results[i];
+		double time = result.seconds / result.iterations * 1e9;
+		double cpuTime = result.cpuSeconds / result.iterations * 1e9;
+		out << (i == 0 ? "" : ",") << std::endl;
+		out << "    {" << std::endl;
+		out << "      \"name\": " << quote(result.name) << "," << std::endl;
+		out << "      \"run_name\": " << quote(result.name) << "," << std::endl;
+		out << "      \"run_type\": \"iteration\"," << std::endl;
+		out << "      \"iterations\": " << result.iterations << "," << std::endl;
+		out << "      \"real_time\": " << time << "," << std::endl;
+		out << "      \"cpu_time\": " << cpuTime << "," << std::endl;
+		out << "      \"time_unit\": \"ns\"";
+		if (result.items > 0) {
+			out << "," << std::endl << "      \"items_per_second\": " << result.items * result.iterations / result.seconds;
+		}
+		if (result.bytes > 0) {
+			out << "," << std::endl << "      \"bytes_per_second\": " << result.bytes * result.iterations / result.seconds;
+		}
+		out << std::endl << "    }";
+	}
+	out << std::endl << "  ]" << std::endl;
+	out << "}" << std::endl;
+}
@@ -0,0 +1,88 @@
+#ifndef QUANTUMSIMULATOR_BENCHMARK_H
+#define QUANTUMSIMULATOR_BENCHMARK_H
+
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+namespace bench {
+
+	/**
+	 * A minimal benchmark runner. Every benchmark is a task that runs a given number of iterations;
+	 * the number of iterations is raised until the task takes long enough to be measured reliably.
+	 * The results are written in the JSON format of Google Benchmark, so the usual tools
+	 * (eg.: it's compare.py) can be used to compare two runs.
+	 */
+	class Benchmark {
+	public:
+
+		/**
+		 * A benchmarked task, running the given number of iterations.
+		 */
+		typedef std::function<void(unsigned long iterations)> Task;
+
+	private:
+
+		/**
+		 * The measurements of a benchmark.
+		 */
+		struct Result {
+			std::string name;
+			unsigned long iterations;
+			double seconds;
+			double cpuSeconds;
+			double items;
+			double bytes;
+		};
+
+		std::string filter;
+		double minTime;
+		std::vector<Result> results;
+
+	public:
+
+		/**
+		 * Creates a runner that only runs the benchmarks whose name contains the filter,
+		 * each of them for at least the given time.
+		 *
+		 * @param filter The part of the names of the benchmarks to run (empty runs everything)
+		 * @param minTime The minimal running time of a benchmark in seconds
+		 */
+		Benchmark(const std::string &filter, double minTime);
+
+		/**
+		 * Returns true if the benchmark with the given name would be run.
+		 * Useful for skipping the expensive preparations of the filtered benchmarks.
+		 *
+		 * @param name The name of the benchmark
+		 * @return True if the benchmark is selected
+		 */
+		bool isSelected(const std::string &name) const;
+
+		/**
+		 * Runs a benchmark (if it's selected) and stores it's result.
+		 * The throughputs are computed from the work done in one iteration.
+		 *
+		 * @param name The name of the benchmark
+		 * @param task The benchmarked task
+		 * @param items The number of items processed in one iteration (eg.: amplitudes or shots)
+		 * @param bytes The number of bytes processed in one iteration
+		 */
+		void run(const std::string &name, const Task &task, double items = 0, double bytes = 0);
+
+		/**
+		 * Writes the results to the given output stream as a JSON document.
+		 *
+		 * @param out The output stream
+		 * @param threads The number of threads the simulator used
+		 */
+		void printJson(std::ostream &out, unsigned long threads) const;
+	};
+}
+
+using namespace bench;
+
+
+#endif //QUANTUMSIMULATOR_BENCHMARK_H
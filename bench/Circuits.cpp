@@ -0,0 +1,127 @@
+#include <sstream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include "Circuits.h"
+
+std::string Circuits::header(unsigned long qubitCount, unsigned long bitCount) {
+	std::ostringstream out;
+	out << "OPENQASM 2.0;\n";
+	out << "gate h a { U(pi/2,0,pi) a; }\n";
+	out << "gate x a { U(pi,0,pi) a; }\n";
+	out << "gate u1(lambda) a { U(0,0,lambda) a; }\n";
+	out << "gate t a { u1(pi/4) a; }\n";
+	out << "gate tdg a { u1(-pi/4) a; }\n";
+	out << "gate cz a,b { h b; CX a,b; h b; }\n";
+	out << "gate cu1(lambda) a,b { u1(lambda/2) a; CX a,b; u1(-lambda/2) b; CX a,b; u1(lambda/2) b; }\n";
+	out << "gate swap a,b { CX a,b; CX b,a; CX a,b; }\n";
+	out << "gate ccx a,b,c { h c; CX b,c; tdg c; CX a,c; t c; CX b,c; tdg c; CX a,c; t b; t c; h c; CX a,b; t a; tdg b; CX a,b; }\n";
+	out << "qreg q[" << qubitCount << "];\n";
+	out << "creg c[" << bitCount << "];\n";
+	return out.str();
+}
+
+std::string Circuits::ghz(unsigned long qubitCount) {
+	std::ostringstream out;
+	out << header(qubitCount, qubitCount);
+	out << "h q[0];\n";
+	for (unsigned long i = 1; i < qubitCount; i++) out << "CX q[" << i - 1 << "],q[" << i << "];\n";
+	out << "measure q -> c;\n";
+	return out.str();
+}
+
+std::string Circuits::qft(unsigned long qubitCount) {
+	std::ostringstream out;
+	out << header(qubitCount, qubitCount);
+	for (unsigned long i = 0; i < qubitCount; i += 2) out << "x q[" << i << "];\n";
+	for (unsigned long i = 0; i < qubitCount; i++) {
+		out << "h q[" << i << "];\n";
+		for (unsigned long j = i + 1; j < qubitCount; j++) {
+			out << "cu1(pi/" << (1ul << (j - i)) << ") q[" << j << "],q[" << i << "];\n";
+		}
+	}
+	for (unsigned long i = 0; i < qubitCount / 2; i++) out << "swap q[" << i << "],q[" << qubitCount - i - 1 << "];\n";
+	out << "measure q -> c;\n";
+	return out.str();
+}
+
+std::string Circuits::grover(unsigned long qubitCount) {
+	// q[0, n) are searched, q[n, 2n-2) hold the partial products of the multi-controlled Z
+	std::ostringstream mcz;
+	unsigned long n = qubitCount;
+	mcz << "ccx q[0],q[1],q[" << n << "];\n";
+	for (unsigned long i = 2; i < n - 1; i++) mcz << "ccx q[" << i << "],q[" << n + i - 2 << "],q[" << n + i - 1 << "];\n";
+	mcz << "cz q[" << 2 * n - 3 << "],q[" << n - 1 << "];\n";
+	for (unsigned long i = n - 2; i >= 2; i--) mcz << "ccx q[" << i << "],q[" << n + i - 2 << "],q[" << n + i - 1 << "];\n";
+	mcz << "ccx q[0],q[1],q[" << n << "];\n";
+
+	std::ostringstream out;
+	out << header(2 * n - 2, n);
+	for (unsigned long i = 0; i < n; i++) out << "h q[" << i << "];\n";
+	unsigned long iterations = (unsigned long) (M_PI / 4 * std::sqrt((double) (1ul << n)));
+	for (unsigned long iteration = 0; iteration < iterations; iteration++) {
+		out << mcz.str();
+		for (unsigned long i = 0; i < n; i++) out << "h q[" << i << "];\nx q[" << i << "];\n";
+		out << mcz.str();
+		for (unsigned long i = 0; i < n; i++) out << "x q[" << i << "];\nh q[" << i << "];\n";
+	}
+	for (unsigned long i = 0; i < n; i++) out << "measure q[" << i << "] -> c[" << i << "];\n";
+	return out.str();
+}
+
+std::string Circuits::random(unsigned long qubitCount, unsigned long depth, unsigned long seed) {
+	std::mt19937_64 generator(seed);
+	std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+	std::vector<unsigned long> qubits(qubitCount);
+	for (unsigned long i = 0; i < qubitCount; i++) qubits[i] = i;
+
+	std::ostringstream out;
+	out << header(qubitCount, qubitCount);
+	// The real literals of OpenQASM have no exponent
+	out << std::fixed;
+	out.precision(15);
+	for (unsigned long layer = 0; layer < depth; layer++) {
+		for (unsigned long i = 0; i < qubitCount; i++) {
+			out << "U(" << angle(generator) << "," << angle(generator) << "," << angle(generator) << ") q[" << i << "];\n";
+		}
+		std::shuffle(qubits.begin(), qubits.end(), generator);
+		for (unsigned long i = 0; i + 1 < qubitCount; i += 2) out << "CX q[" << qubits[i] << "],q[" << qubits[i + 1] << "];\n";
+	}
+	out << "measure q -> c;\n";
+	return out.str();
+}
+
+std::string Circuits::chain(unsigned long qubitCount, unsigned long depth, unsigned long seed) {
+	std::mt19937_64 generator(seed);
+	std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+
+	// The outcomes are 64 bit integers, so at most 64 qubits are measured
+	unsigned long bitCount = std::min(qubitCount, 64ul);
+	std::ostringstream out;
+	out << header(qubitCount, bitCount);
+	out << std::fixed;
+	out.precision(15);
+	for (unsigned long layer = 0; layer < depth; layer++) {
+		for (unsigned long i = 0; i < qubitCount; i++) {
+			out << "U(" << angle(generator) << ",0," << angle(generator) << ") q[" << i << "];\n";
+		}
+		for (unsigned long i = layer % 2; i + 1 < qubitCount; i += 2) out << "CX q[" << i << "],q[" << i + 1 << "];\n";
+	}
+	for (unsigned long i = 0; i < bitCount; i++) out << "measure q[" << i << "] -> c[" << i << "];\n";
+	return out.str();
+}
+
+std::string Circuits::dynamic(unsigned long qubitCount, unsigned long depth) {
+	std::ostringstream out;
+	out << header(qubitCount, 1);
+	for (unsigned long round = 0; round < depth; round++) {
+		for (unsigned long i = 0; i < qubitCount; i++) out << "h q[" << i << "];\n";
+		for (unsigned long i = 1; i < qubitCount; i++) out << "CX q[" << i - 1 << "],q[" << i << "];\n";
+		out << "measure q[" << round % qubitCount << "] -> c[0];\n";
+		out << "if(c==1) x q[" << (round + 1) % qubitCount << "];\n";
+		out << "reset q[" << round % qubitCount << "];\n";
+	}
+	out << "measure q[0] -> c[0];\n";
+	return out.str();
+}
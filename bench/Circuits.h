@@ -0,0 +1,91 @@
+#ifndef QUANTUMSIMULATOR_CIRCUITS_H
+#define QUANTUMSIMULATOR_CIRCUITS_H
+
+
+#include <string>
+
+namespace bench {
+
+	/**
+	 * Generates the OpenQASM sources of the benchmarked circuits. The sources are self-contained
+	 * (they define the gates they use instead of including qelib1.inc), and the random ones
+	 * only depend on their seed, so the same circuits are measured on every machine.
+	 */
+	class Circuits {
+	private:
+
+		/**
+		 * Returns the header of a program with the given number of qubits and bits,
+		 * including the definitions of the used gates.
+		 *
+		 * @param qubitCount The number of qubits
+		 * @param bitCount The number of bits
+		 * @return The header
+		 */
+		static std::string header(unsigned long qubitCount, unsigned long bitCount);
+
+	public:
+
+		/**
+		 * Prepares a GHZ state and measures it.
+		 *
+		 * @param qubitCount The number of qubits
+		 * @return The source
+		 */
+		static std::string ghz(unsigned long qubitCount);
+
+		/**
+		 * Applies a quantum Fourier transform to a basis state and measures the result.
+		 *
+		 * @param qubitCount The number of qubits
+		 * @return The source
+		 */
+		static std::string qft(unsigned long qubitCount);
+
+		/**
+		 * Searches for the all ones state with Grover's algorithm. The multi-controlled
+		 * gates are built from Toffoli gates, using qubitCount - 2 extra qubits.
+		 *
+		 * @param qubitCount The number of searched qubits (at least 3)
+		 * @return The source
+		 */
+		static std::string grover(unsigned long qubitCount);
+
+		/**
+		 * Applies layers of random single qubit gates and CX gates on random qubit pairs.
+		 *
+		 * @param qubitCount The number of qubits
+		 * @param depth The number of layers
+		 * @param seed The seed of the random choices
+		 * @return The source
+		 */
+		static std::string random(unsigned long qubitCount, unsigned long depth, unsigned long seed);
+
+		/**
+		 * Applies layers of random single qubit rotations and CX gates between neighbouring qubits
+		 * of a line (alternating between the even and odd pairs), like a hardware efficient variational circuit.
+		 * It's weakly entangled if the depth is small, so it can be simulated by a matrix product state.
+		 *
+		 * @param qubitCount The number of qubits
+		 * @param depth The number of layers
+		 * @param seed The seed of the random angles
+		 * @return The source
+		 */
+		static std::string chain(unsigned long qubitCount, unsigned long depth, unsigned long seed);
+
+		/**
+		 * Repeatedly measures a qubit, conditionally flips it's neighbour and resets it,
+		 * so every shot has to be executed on it's own (it can't be sampled).
+		 *
+		 * @param qubitCount The number of qubits
+		 * @param depth The number of rounds
+		 * @return The source
+		 */
+		static std::string dynamic(unsigned long qubitCount, unsigned long depth);
+	};
+}
+
+using namespace bench;
+
+
+#endif //QUANTUMSIMULATOR_CIRCUITS_H
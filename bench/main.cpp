@@ -0,0 +1,287 @@
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <string>
+#include "Benchmark.h"
+#include "Circuits.h"
+#include "../src/tokenizer/Tokenizer.h"
+#include "../src/ast/Builder.h"
+#include "../src/compiler/Compiler.h"
+#include "../src/compiler/Program.h"
+#include "../src/compiler/NoiseModel.h"
+#include "../src/math/Environment.h"
+
+void printUsage(std::string program) {
+	std::cerr << "Usage: " << program
+	          << " [--filter <text>] [--min-time <seconds>] [--threads <count>] [--max-qubits <count>] [--out <file>]"
+	          << std::endl;
+}
+
+/**
+ * Writes the given source to a file in the temporary directory and returns it's path.
+ *
+ * @param name The name of the file (with it's extension)
+ * @param source The source
+ * @return The path of the file
+ */
+std::string writeFile(const std::string &name, const std::string &source) {
+	std::string file = (std::filesystem::temp_directory_path() / ("quantumsimulator_bench_" + name)).string();
+	std::ofstream out(file, std::ios::binary);
+	out << source;
+	return file;
+}
+
+/**
+ * Parses and compiles the given file into a program.
+ *
+ * @param file The path of the file
+ * @param matrixProductState Simulates the program by a matrix product state
+ * @param noise The noise model (or null for a noiseless simulation)
+ * @param trajectories Simulates the noise by sampling trajectories on a state vector
+ * @return The program
+ */
+Program *compileFile(const std::string &file, bool matrixProductState = false, const NoiseModel *noise = nullptr,
+                     bool trajectories = false) {
+	ProgramAST *ast;
+	{
+		Source source(file);
+		ast = Builder::build(Tokenizer::tokenize(source));
+	}
+	Program *program = Compiler::compile(ast, true, matrixProductState, noise, trajectories);
+	delete ast;
+	return program;
+}
+
+/**
+ * Measures the front end: tokenizing a big file, building it's tree and compiling it.
+ */
+void benchmarkFrontEnd(Benchmark &benchmark) {
+	if (!benchmark.isSelected("frontend/tokenize") && !benchmark.isSelected("frontend/build") &&
+	    !benchmark.isSelected("frontend/compile")) return;
+
+	std::string source = Circuits::random(16, 4000, 1);
+	std::string file = writeFile("frontend.qasm", source);
+	unsigned long lines = std::count(source.begin(), source.end(), '\n');
+
+	benchmark.run("frontend/tokenize", [&](unsigned long iterations) {
+		for (unsigned long i = 0; i < iterations; i++) {
+			Source input(file);
+			Tokenizer::tokenize(input);
+		}
+	}, lines, source.size());
+
+	// The tokens refer to the source, so it's kept until the end
+	Source input(file);
+	std::vector<Token> tokens = Tokenizer::tokenize(input);
+	benchmark.run("frontend/build", [&](unsigned long iterations) {
+		for (unsigned long i = 0; i < iterations; i++) delete Builder::build(tokens);
+	}, lines);
+
+	ProgramAST *ast = Builder::build(tokens);
+	benchmark.run("frontend/compile", [&](unsigned long iterations) {
+		for (unsigned long i = 0; i < iterations; i++) delete Compiler::compile(ast);
+	}, lines);
+	delete ast;
+
+	std::filesystem::remove(file);
+}
+
+/**
+ * Measures the gate kernels of the environment for different qubit counts and target qubits.
+ * The throughput is given in amplitudes per second.
+ * The benchmarks of the single precision environment are named kernel_single/...
+ */
+template<typename Scalar>
+void benchmarkKernels(Benchmark &benchmark, unsigned long maxQubits, const std::string &prefix) {
+	const Complex h = Complex(1 / sqrt(2.0));
+	const Complex transform[2][2] = {{h, h}, {h, -h}};
+	const Complex phase = Complex(cos(0.3), sin(0.3));
+
+	for (unsigned long qubitCount = 10; qubitCount <= maxQubits; qubitCount += 4) {
+		BasicEnvironment<Scalar> env(0, qubitCount, 1);
+		double amplitudes = env.getStateCount();
+		std::string size = "/" + std::to_string(qubitCount);
+
+		for (unsigned long qubit : {0ul, qubitCount / 2, qubitCount - 1}) {
+			std::string target = size + "/" + std::to_string(qubit);
+			benchmark.run(prefix + "/transform" + target, [&](unsigned long iterations) {
+				for (unsigned long i = 0; i < iterations; i++) env.applyTransform(qubit, transform);
+			}, amplitudes);
+			benchmark.run(prefix + "/diagonal" + target, [&](unsigned long iterations) {
+				for (unsigned long i = 0; i < iterations; i++) env.applyDiagonal(qubit, phase, phase);
+			}, amplitudes);
+			benchmark.run(prefix + "/anti_diagonal" + target, [&](unsigned long iterations) {
+				for (unsigned long i = 0; i < iterations; i++) env.applyAntiDiagonal(qubit, phase, phase);
+			}, amplitudes);
+			unsigned long control = qubit == 0 ? 1 : 0;
+			benchmark.run(prefix + "/cx" + target, [&](unsigned long iterations) {
+				for (unsigned long i = 0; i < iterations; i++) env.applyNot(qubit, 1ul << control);
+			}, amplitudes);
+		}
+
+		// Fused transforms on the lowest and highest qubits
+		for (unsigned long count : {2ul, 5ul}) {
+			std::vector<Complex> matrix(1ul << (2 * count));
+			for (unsigned long i = 0; i < (1ul << count); i++) matrix[i * (1ul << count) + i] = phase;
+			for (bool high : {false, true}) {
+				std::vector<unsigned long> qubits;
+				for (unsigned long i = 0; i < count; i++) qubits.push_back(high ? qubitCount - count + i : i);
+				std::string name = prefix + "/fused" + std::to_string(count) + size + (high ? "/high" : "/low");
+				benchmark.run(name, [&](unsigned long iterations) {
+					for (unsigned long i = 0; i < iterations; i++) env.applyTransform(qubits.data(), count, matrix.data());
+				}, amplitudes);
+			}
+		}
+
+		unsigned long measured[1] = {0};
+		benchmark.run(prefix + "/measure" + size + "/0", [&](unsigned long iterations) {
+			for (unsigned long i = 0; i < iterations; i++) {
+				env.applyTransform(0, transform);
+				env.measure(measured, 1);
+			}
+		}, amplitudes);
+	}
+}
+
+/**
+ * Measures whole executions of the standard circuits in shots per second.
+ * The noisy circuits are evaluated exactly by a density matrix, and an evaluation counts as one shot,
+ * unless they are simulated by trajectories, drawing the noise in every shot.
+ */
+void benchmarkCircuits(Benchmark &benchmark, unsigned long maxQubits, unsigned long threads) {
+	struct Circuit {
+		std::string name;
+		std::function<std::string()> source;
+		unsigned long shots = 1;
+		bool matrixProductState = false;
+		std::string noise;
+		bool trajectories = false;
+		bool singlePrecision = false;
+
+		Circuit(std::string name, std::function<std::string()> source, unsigned long shots)
+				: name(std::move(name)), source(std::move(source)), shots(shots) {
+
+		}
+	};
+
+	const std::string noiseRules = "U depolarizing 0.001\nCX depolarizing 0.01\n* amplitude_damping 0.002\nreadout 0.02 0.03\n";
+
+	std::vector<Circuit> circuits;
+	for (unsigned long qubitCount : {10ul, 16ul, 20ul, 24ul}) {
+		if (qubitCount > maxQubits) continue;
+		std::string size = "/" + std::to_string(qubitCount);
+		circuits.emplace_back("circuit/ghz" + size, [=] { return Circuits::ghz(qubitCount); }, 1000);
+		circuits.emplace_back("circuit/qft" + size, [=] { return Circuits::qft(qubitCount); }, 1000);
+		circuits.emplace_back("circuit/random" + size, [=] { return Circuits::random(qubitCount, 20, qubitCount); }, 1000);
+		circuits.emplace_back("circuit/random_single" + size, [=] { return Circuits::random(qubitCount, 20, qubitCount); },
+		                      1000);
+		circuits.back().singlePrecision = true;
+		if (qubitCount <= 16) {
+			circuits.emplace_back("circuit/dynamic" + size, [=] { return Circuits::dynamic(qubitCount, 10); }, 20);
+			circuits.emplace_back("circuit/trajectories" + size, [=] { return Circuits::chain(qubitCount, 8, qubitCount); }, 20);
+			circuits.back().noise = noiseRules;
+			circuits.back().trajectories = true;
+		}
+	}
+	for (unsigned long qubitCount : {6ul, 8ul, 10ul}) {
+		if (2 * qubitCount - 2 > maxQubits) continue;
+		std::string size = "/" + std::to_string(qubitCount);
+		circuits.emplace_back("circuit/grover" + size, [=] { return Circuits::grover(qubitCount); }, 1000);
+	}
+	// The matrix product state isn't limited by the number of qubits
+	for (unsigned long qubitCount : {60ul, 100ul}) {
+		std::string size = "/" + std::to_string(qubitCount);
+		circuits.emplace_back("circuit/mps_chain" + size, [=] { return Circuits::chain(qubitCount, 8, qubitCount); }, 1000);
+		circuits.back().matrixProductState = true;
+	}
+	// The density matrix takes as much memory as a state vector of twice as many qubits
+	for (unsigned long qubitCount : {6ul, 8ul, 10ul}) {
+		if (2 * qubitCount > maxQubits) continue;
+		std::string size = "/" + std::to_string(qubitCount);
+		circuits.emplace_back("circuit/noisy_chain" + size, [=] { return Circuits::chain(qubitCount, 8, qubitCount); }, 1);
+		circuits.back().noise = noiseRules;
+	}
+
+	for (const Circuit &circuit : circuits) {
+		if (!benchmark.isSelected(circuit.name)) continue;
+
+		std::string name = circuit.name.substr(circuit.name.find('/') + 1);
+		std::replace(name.begin(), name.end(), '/', '_');
+		std::string file = writeFile(name + ".qasm", circuit.source());
+		NoiseModel noise;
+		if (!circuit.noise.empty()) {
+			std::string noiseFile = writeFile(name + ".noise", circuit.noise);
+			noise = NoiseModel::load(noiseFile);
+			std::filesystem::remove(noiseFile);
+		}
+
+		Program *program = compileFile(file, circuit.matrixProductState, circuit.noise.empty() ? nullptr : &noise,
+		                               circuit.trajectories);
+		program->setSeed(1);
+		if (circuit.singlePrecision) program->setSinglePrecision(true);
+		benchmark.run(circuit.name, [&](unsigned long iterations) {
+			for (unsigned long i = 0; i < iterations; i++) {
+				if (circuit.noise.empty() || circuit.trajectories) {
+					program->run(circuit.shots, threads);
+				} else {
+					program->evaluate();
+				}
+			}
+		}, circuit.shots);
+		delete program;
+		std::filesystem::remove(file);
+	}
+}
+
+int main(int argc, const char *argv[]) {
+	std::string filter;
+	double minTime = 0.5;
+	unsigned long threads = 1;
+	unsigned long maxQubits = 22;
+	std::string out;
+
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		if (i + 1 == argc) {
+			std::cerr << "Missing value for " << argument << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+		std::string value = argv[++i];
+		try {
+			if (argument == "--filter") filter = value;
+			else if (argument == "--min-time") minTime = std::stod(value);
+			else if (argument == "--threads") threads = std::stoul(value);
+			else if (argument == "--max-qubits") maxQubits = std::stoul(value);
+			else if (argument == "--out") out = value;
+			else {
+				std::cerr << "Unknown option " << argument << std::endl;
+				printUsage(argv[0]);
+				return 1;
+			}
+		} catch (const std::logic_error &) {
+			std::cerr << "Invalid value for " << argument << std::endl;
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	Environment::setThreadCount(threads);
+	Benchmark benchmark(filter, minTime);
+	benchmarkFrontEnd(benchmark);
+	benchmarkKernels<double>(benchmark, maxQubits, "kernel");
+	benchmarkKernels<float>(benchmark, maxQubits, "kernel_single");
+	benchmarkCircuits(benchmark, maxQubits, threads);
+
+	if (out.empty()) {
+		benchmark.printJson(std::cout, threads);
+	} else {
+		std::ofstream file(out);
+		benchmark.printJson(file, threads);
+	}
+	return 0;
+}
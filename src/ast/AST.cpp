@@ -18,13 +18,13 @@ AST::Type AST::getType() const {
 
 // PROGRAM
 
-ProgramAST::ProgramAST(const Coordinate &coordinate, const double version, const std::vector<AST *> &commands) :
-		AST(coordinate, PROGRAM), version(version), commands(commands) {
+ProgramAST::ProgramAST(const Coordinate &coordinate, const double version, const std::vector<AST *> &commands, Arena *arena) :
+		AST(coordinate, PROGRAM), version(version), commands(commands), arena(arena) {
 
 }
 
 ProgramAST::~ProgramAST() {
-	for (AST *command : commands) delete command;
+	delete arena;
 }
 
 double ProgramAST::getVersion() const {
@@ -37,16 +37,19 @@ const std::vector<AST *> &ProgramAST::getCommands() const {
 
 // INCLUDE
 
-IncludeAST::IncludeAST(const Coordinate &coordinate, std::vector<AST *> &commands) :
-		AST(coordinate, INCLUDE), commands(commands) {
+IncludeAST::Commands IncludeAST::share(const std::vector<AST *> &commands, Arena *arena) {
+	return Commands(new std::vector<AST *>(commands), [arena](const std::vector<AST *> *commands) {
+		delete commands;
+		delete arena;
+	});
 }
 
-IncludeAST::~IncludeAST() {
-	for (AST *command : commands) delete command;
+IncludeAST::IncludeAST(const Coordinate &coordinate, const Commands &commands) :
+		AST(coordinate, INCLUDE), commands(commands) {
 }
 
 const std::vector<AST *> &IncludeAST::getCommands() const {
-	return commands;
+	return *commands;
 }
 
 // CREG
@@ -127,10 +130,6 @@ GateDeclarationAST::GateDeclarationAST(const Coordinate &coordinate, const std::
 
 }
 
-GateDeclarationAST::~GateDeclarationAST() {
-	for (AST *command : commands) delete command;
-}
-
 const std::string &GateDeclarationAST::getName() const {
 	return name;
 }
@@ -187,11 +186,6 @@ OperationAST::OperationAST(const Coordinate &coordinate, const char operation,
 
 }
 
-OperationAST::~OperationAST() {
-	delete left;
-	delete right;
-}
-
 char OperationAST::getOperation() const {
 	return operation;
 }
@@ -250,11 +244,6 @@ GateAST::GateAST(const Coordinate &coordinate, const std::string &name,
 
 }
 
-GateAST::~GateAST() {
-	for (ExpressionAST *expression : parameters) delete expression;
-	for (QRegAST *qreg : arguments) delete qreg;
-}
-
 const std::string &GateAST::getName() const {
 	return name;
 }
@@ -274,10 +263,6 @@ BarrierAST::BarrierAST(const Coordinate &coordinate, const std::vector<QRegAST *
 
 }
 
-BarrierAST::~BarrierAST() {
-	for (QRegAST *qreg : arguments) delete qreg;
-}
-
 const std::vector<QRegAST *> &BarrierAST::getArguments() const {
 	return arguments;
 }
@@ -289,10 +274,6 @@ ResetAST::ResetAST(const Coordinate &coordinate, QRegAST *target) :
 
 }
 
-ResetAST::~ResetAST() {
-	delete target;
-}
-
 QRegAST *ResetAST::getTarget() const {
 	return target;
 }
@@ -304,11 +285,6 @@ MeasureAST::MeasureAST(const Coordinate &coordinate, QRegAST *source, CRegAST *t
 
 }
 
-MeasureAST::~MeasureAST() {
-	delete source;
-	delete target;
-}
-
 QRegAST *MeasureAST::getSource() const {
 	return source;
 }
@@ -324,11 +300,6 @@ ConditionAST::ConditionAST(const Coordinate &coordinate, CRegAST *reg, unsigned
 
 }
 
-ConditionAST::~ConditionAST() {
-	delete reg;
-	delete command;
-}
-
 CRegAST *ConditionAST::getReg() const {
 	return reg;
 }
@@ -3,7 +3,9 @@
 
 
 #include <vector>
+#include <memory>
 #include "../tokenizer/Coordinate.h"
+#include "Arena.h"
 
 namespace ast { namespace asts {
 
@@ -42,8 +44,8 @@ namespace ast { namespace asts {
 		AST(const Coordinate &coordinate, Type type);
 
 		/**
-		 * Deletes the abstract syntax tree node's children.
-		 * Every node is responsible for the deletion of its children.
+		 * The nodes are owned by the arena they were created in,
+		 * so the children are deleted by the arena, not by their parent.
 		 */
 		virtual ~AST();
 
@@ -66,17 +68,19 @@ namespace ast { namespace asts {
 
 	/**
 	 * Represents the whole program itself by it's version
-	 * and all of it's commands.
+	 * and all of it's commands. The program owns the arena
+	 * of it's tree, so deleting the program deletes every node.
 	 */
 	class ProgramAST : public AST {
 	private:
 
 		double version;
 		std::vector<AST *> commands;
+		Arena *arena;
 
 	public:
 
-		ProgramAST(const Coordinate &coordinate, double version, const std::vector<AST *> &commands);
+		ProgramAST(const Coordinate &coordinate, double version, const std::vector<AST *> &commands, Arena *arena);
 		~ProgramAST() override;
 
 		double getVersion() const;
@@ -87,14 +91,30 @@ namespace ast { namespace asts {
 	 * Represents an included source code by the included commands
 	 */
 	class IncludeAST : public AST {
+	public:
+
+		/**
+		 * The commands of an included source code. They can be shared between
+		 * the includes of the same file, and they are deleted with the last one.
+		 */
+		typedef std::shared_ptr<const std::vector<AST *>> Commands;
+
+		/**
+		 * Takes the ownership of the given commands and their arena, so that they can be shared.
+		 *
+		 * @param commands The commands
+		 * @param arena The arena of the commands
+		 * @return The shared commands
+		 */
+		static Commands share(const std::vector<AST *> &commands, Arena *arena);
+
 	private:
 
-		std::vector<AST *> commands;
+		Commands commands;
 
 	public:
 
-		IncludeAST(const Coordinate &coordinate, std::vector<AST *> &commands);
-		~IncludeAST() override;
+		IncludeAST(const Coordinate &coordinate, const Commands &commands);
 
 		const std::vector<AST *> &getCommands() const;
 	};
@@ -194,7 +214,6 @@ namespace ast { namespace asts {
 	public:
 
 		GateDeclarationAST(const Coordinate &coordinate, const std::string &name, const std::vector<std::string> &parameters, const std::vector<std::string> &arguments, const std::vector<AST *> &commands);
-		~GateDeclarationAST() override;
 
 		const std::string &getName() const;
 		const std::vector<std::string> &getParameters() const;
@@ -276,7 +295,6 @@ namespace ast { namespace asts {
 	public:
 
 		OperationAST(const Coordinate &coordinate, char operation, ExpressionAST *left, ExpressionAST *right);
-		~OperationAST() override;
 
 		char getOperation() const;
 		ExpressionAST *getLeft() const;
@@ -347,7 +365,6 @@ namespace ast { namespace asts {
 	public:
 
 		GateAST(const Coordinate &coordinate, const std::string &name, const std::vector<ExpressionAST *> &parameters, const std::vector<QRegAST *> &arguments);
-		~GateAST() override;
 
 		const std::string &getName() const;
 		const std::vector<ExpressionAST *> &getParameters() const;
@@ -365,7 +382,6 @@ namespace ast { namespace asts {
 	public:
 
 		BarrierAST(const Coordinate &coordinate, const std::vector<QRegAST *> &qreg);
-		~BarrierAST() override;
 
 		const std::vector<QRegAST *> &getArguments() const;
 	};
@@ -381,7 +397,6 @@ namespace ast { namespace asts {
 	public:
 
 		ResetAST(const Coordinate &coordinate, QRegAST *qreg);
-		~ResetAST() override;
 
 		QRegAST *getTarget() const;
 	};
@@ -399,7 +414,6 @@ namespace ast { namespace asts {
 	public:
 
 		MeasureAST(const Coordinate &coordinate, QRegAST *qreg, CRegAST *creg);
-		~MeasureAST() override;
 
 		QRegAST *getSource() const;
 		CRegAST *getTarget() const;
@@ -419,7 +433,6 @@ namespace ast { namespace asts {
 	public:
 
 		ConditionAST(const Coordinate &coordinate, CRegAST *creg, unsigned long integer, AST *command);
-		~ConditionAST() override;
 
 		CRegAST *getReg() const;
 		unsigned long getCriteria() const;
@@ -0,0 +1,30 @@
+#include <algorithm>
+#include "Arena.h"
+
+const unsigned long Arena::BLOCK_SIZE;
+
+Arena::Arena() : current(nullptr), remaining(0) {
+
+}
+
+Arena::~Arena() {
+	for (unsigned long i = destructors.size(); i > 0; i--) destructors[i - 1].destroy(destructors[i - 1].object);
+	for (char *block : blocks) delete[] block;
+}
+
+void *Arena::allocate(unsigned long size, unsigned long alignment) {
+	unsigned long padding = (alignment - (unsigned long) current % alignment) % alignment;
+	if (current == nullptr || padding + size > remaining) {
+		// Objects bigger than a block get a block of their own
+		unsigned long blockSize = std::max(BLOCK_SIZE, size + alignment);
+		blocks.push_back(new char[blockSize]);
+		current = blocks.back();
+		remaining = blockSize;
+		padding = (alignment - (unsigned long) current % alignment) % alignment;
+	}
+
+	void *memory = current + padding;
+	current += padding + size;
+	remaining -= padding + size;
+	return memory;
+}
@@ -0,0 +1,80 @@
+#ifndef QUANTUMSIMULATOR_ARENA_H
+#define QUANTUMSIMULATOR_ARENA_H
+
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace ast {
+
+	/**
+	 * A bump allocator that owns the nodes of an abstract syntax tree. The nodes are
+	 * placed one after the other in big blocks, and they are all destroyed with the arena,
+	 * so they don't have to be allocated and freed one by one.
+	 */
+	class Arena {
+	private:
+
+		/**
+		 * The size of the blocks the objects are placed in.
+		 */
+		static const unsigned long BLOCK_SIZE = 64 * 1024;
+
+		/**
+		 * The destructor of an object in the arena.
+		 */
+		struct Destructor {
+			void (*destroy)(void *object);
+			void *object;
+		};
+
+		std::vector<char *> blocks;
+		char *current;
+		unsigned long remaining;
+		std::vector<Destructor> destructors;
+
+		/**
+		 * Reserves memory in the current block, or in a new one if it's full.
+		 *
+		 * @param size The size of the memory
+		 * @param alignment The alignment of the memory
+		 * @return The reserved memory
+		 */
+		void *allocate(unsigned long size, unsigned long alignment);
+
+	public:
+
+		Arena();
+
+		/**
+		 * Destroys the objects in the reverse order of their creation and frees the blocks.
+		 */
+		~Arena();
+
+		Arena(const Arena &) = delete;
+		Arena &operator=(const Arena &) = delete;
+
+		/**
+		 * Creates an object in the arena. The object is destroyed with the arena,
+		 * so it must not be deleted.
+		 *
+		 * @param arguments The arguments of the object's constructor
+		 * @return The created object
+		 */
+		template<typename T, typename... Arguments>
+		T *create(Arguments &&... arguments) {
+			T *object = new(allocate(sizeof(T), alignof(T))) T(std::forward<Arguments>(arguments)...);
+			if (!std::is_trivially_destructible<T>::value) {
+				destructors.push_back({[](void *object) { ((T *) object)->~T(); }, object});
+			}
+			return object;
+		}
+	};
+}
+
+using namespace ast;
+
+
+#endif //QUANTUMSIMULATOR_ARENA_H
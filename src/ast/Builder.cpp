@@ -19,15 +19,24 @@ Builder::Exception::Exception(const Builder *builder) noexcept :
 
 
 
-ProgramAST *Builder::build(std::vector<Token> tokens) {
-	return Builder(tokens).program();
+std::mutex Builder::includeCacheMutex;
+std::map<std::string, Builder::CachedInclude> Builder::includeCache;
+
+ProgramAST *Builder::build(const std::vector<Token> &tokens) {
+	Arena *arena = new Arena();
+	try {
+		return Builder(tokens, arena).program();
+	} catch (...) {
+		delete arena;
+		throw;
+	}
 }
 
-Builder::Builder(std::vector<Token> &tokens) : tokens(tokens) {
+Builder::Builder(const std::vector<Token> &tokens, Arena *arena) : tokens(tokens), arena(arena) {
 
 }
 
-Token Builder::get() const {
+const Token &Builder::get() const {
 	return tokens[pos];
 }
 
@@ -56,7 +65,7 @@ ProgramAST *Builder::program() {
 	}
 	eat(Token::END);
 
-	return new ProgramAST(coordinate, version, commands);
+	return new ProgramAST(coordinate, version, commands, arena);
 }
 
 IncludeAST *Builder::include() {
@@ -64,29 +73,66 @@ IncludeAST *Builder::include() {
 
 	Coordinate coordinate;
 	std::string file;
-	std::vector<AST *> commands;
-	AST *command;
 
 	coordinate = eat(Token::INCLUDE).getCoordinate();
 	file = eat(Token::STRING).getString();
 	eat(Token::SEMICOLON);
 
-	std::vector<Token> tokens;
-	if (file[0] == PATH_SEPARATOR) {
-		tokens = Tokenizer::tokenize(file);
-	} else {
+	if (file[0] != PATH_SEPARATOR) {
 		const std::string &currentFile = coordinate.getFile();
 		unsigned long lastPathSeparator = currentFile.find_last_of(PATH_SEPARATOR);
-		tokens = Tokenizer::tokenize(currentFile.substr(0, lastPathSeparator + 1) + file);
+		file = currentFile.substr(0, lastPathSeparator + 1) + file;
 	}
 
-	Builder builder(tokens);
-	while ((command = builder.program_command()) != nullptr) {
-		commands.push_back(command);
+	return arena->create<IncludeAST>(coordinate, buildInclude(file));
+}
+
+IncludeAST::Commands Builder::buildInclude(const std::string &file) {
+	// The cache is keyed by the canonical path, so that the different paths of a file share the same entry.
+	// If the file can't be examined, it isn't cached (and loading it reports the error).
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::canonical(file, error);
+	std::filesystem::file_time_type time;
+	std::uintmax_t size = 0;
+	if (!error) time = std::filesystem::last_write_time(path, error);
+	if (!error) size = std::filesystem::file_size(path, error);
+
+	if (!error) {
+		std::lock_guard<std::mutex> lock(includeCacheMutex);
+		auto cached = includeCache.find(path.string());
+		if (cached != includeCache.end() && cached->second.time == time && cached->second.size == size) {
+			return cached->second.commands;
+		}
 	}
-	builder.eat(Token::END);
 
-	return new IncludeAST(coordinate, commands);
+	// The AST copies everything it needs from the tokens, so the source can be unloaded after building
+	std::vector<AST *> commands;
+	AST *command;
+	Arena *arena = new Arena();
+	try {
+		Source source(file);
+		std::vector<Token> tokens = Tokenizer::tokenize(source);
+		Builder builder(tokens, arena);
+		while ((command = builder.program_command()) != nullptr) {
+			commands.push_back(command);
+		}
+		builder.eat(Token::END);
+	} catch (...) {
+		delete arena;
+		throw;
+	}
+
+	IncludeAST::Commands shared = IncludeAST::share(commands, arena);
+	if (!error) {
+		std::lock_guard<std::mutex> lock(includeCacheMutex);
+		includeCache[path.string()] = {time, size, shared};
+	}
+	return shared;
+}
+
+void Builder::clearIncludeCache() {
+	std::lock_guard<std::mutex> lock(includeCacheMutex);
+	includeCache.clear();
 }
 
 
@@ -171,7 +217,7 @@ CRegAST *Builder::creg() {
 		index = 0;
 	}
 
-	return new CRegAST(coordinate, name, indexed, index);
+	return arena->create<CRegAST>(coordinate, name, indexed, index);
 }
 
 CRegDeclarationAST *Builder::creg_declaration() {
@@ -188,7 +234,7 @@ CRegDeclarationAST *Builder::creg_declaration() {
 	eat(Token::RBRACKET);
 	eat(Token::SEMICOLON);
 
-	return new CRegDeclarationAST(coordinate, name, size);
+	return arena->create<CRegDeclarationAST>(coordinate, name, size);
 }
 
 
@@ -214,7 +260,7 @@ QRegAST *Builder::qreg() {
 		index = 0;
 	}
 
-	return new QRegAST(coordinate, name, indexed, index);
+	return arena->create<QRegAST>(coordinate, name, indexed, index);
 }
 
 QRegDeclarationAST *Builder::qreg_declaration() {
@@ -231,7 +277,7 @@ QRegDeclarationAST *Builder::qreg_declaration() {
 	eat(Token::RBRACKET);
 	eat(Token::SEMICOLON);
 
-	return new QRegDeclarationAST(coordinate, name, size);
+	return arena->create<QRegDeclarationAST>(coordinate, name, size);
 }
 
 
@@ -255,10 +301,10 @@ std::vector<std::string> Builder::arguments() {
 
 	std::vector<std::string> arguments;
 
-	arguments.push_back(eat(Token::NAME).getValue());
+	arguments.emplace_back(eat(Token::NAME).getValue());
 	while (get().getType() == Token::COMMA) {
 		eat(Token::COMMA);
-		arguments.push_back(eat(Token::NAME).getValue());
+		arguments.emplace_back(eat(Token::NAME).getValue());
 	}
 
 	return arguments;
@@ -270,10 +316,10 @@ std::vector<std::string> Builder::parameters() {
 	std::vector<std::string> parameters;
 
 	if (get().getType() == Token::NAME) {
-		parameters.push_back(eat(Token::NAME).getValue());
+		parameters.emplace_back(eat(Token::NAME).getValue());
 		while (get().getType() == Token::COMMA) {
 			eat(Token::COMMA);
-			parameters.push_back(eat(Token::NAME).getValue());
+			parameters.emplace_back(eat(Token::NAME).getValue());
 		}
 	}
 
@@ -306,7 +352,7 @@ GateDeclarationAST *Builder::gate_declaration() {
 	}
 	eat(Token::GATE_END);
 
-	return new GateDeclarationAST(coordinate, name, parameters, arguments, commands);
+	return arena->create<GateDeclarationAST>(coordinate, name, parameters, arguments, commands);
 }
 
 OpaqueDeclarationAST *Builder::opaque_declaration() {
@@ -327,7 +373,7 @@ OpaqueDeclarationAST *Builder::opaque_declaration() {
 	arguments = Builder::arguments();
 	eat(Token::SEMICOLON);
 
-	return new OpaqueDeclarationAST(coordinate, name, parameters, arguments);
+	return arena->create<OpaqueDeclarationAST>(coordinate, name, parameters, arguments);
 }
 
 
@@ -364,7 +410,7 @@ ExpressionAST *Builder::expression() {
 	while (get().getType() == Token::PLUS || get().getType() == Token::MINUS) {
 		Token tmp = eat(get().getType());
 		operation = tmp.getValue()[0];
-		expression = new OperationAST(tmp.getCoordinate(), operation, expression, product());
+		expression = arena->create<OperationAST>(tmp.getCoordinate(), operation, expression, product());
 	}
 
 	return expression;
@@ -380,7 +426,7 @@ ExpressionAST *Builder::product() {
 	while (get().getType() == Token::MUL || get().getType() == Token::DIV) {
 		Token tmp = eat(get().getType());
 		operation = tmp.getValue()[0];
-		expression = new OperationAST(tmp.getCoordinate(), operation, expression, pow());
+		expression = arena->create<OperationAST>(tmp.getCoordinate(), operation, expression, pow());
 	}
 
 	return expression;
@@ -396,7 +442,7 @@ ExpressionAST *Builder::pow() {
 	while (get().getType() == Token::POW) {
 		Token tmp = eat(get().getType());
 		operation = tmp.getValue()[0];
-		return new OperationAST(tmp.getCoordinate(), operation, expression, value());
+		return arena->create<OperationAST>(tmp.getCoordinate(), operation, expression, value());
 	}
 
 	return expression;
@@ -424,15 +470,15 @@ ExpressionAST *Builder::value() {
 			operation = get().getValue()[0];
 			coordinate = eat(get().getType()).getCoordinate();
 			expression = Builder::expression();
-			return new OperationAST(coordinate, operation, new ValueAST(coordinate, 0), expression);
+			return arena->create<OperationAST>(coordinate, operation, arena->create<ValueAST>(coordinate, 0), expression);
 		case Token::INTEGER:
 			integer = get().getInt();
 			coordinate = eat(Token::INTEGER).getCoordinate();
-			return new ValueAST(coordinate, integer);
+			return arena->create<ValueAST>(coordinate, integer);
 		case Token::REAL:
 			real = get().getReal();
 			coordinate = eat(Token::REAL).getCoordinate();
-			return new ValueAST(coordinate, real);
+			return arena->create<ValueAST>(coordinate, real);
 		case Token::NAME:
 			name = get().getValue();
 			coordinate = eat(Token::NAME).getCoordinate();
@@ -440,9 +486,9 @@ ExpressionAST *Builder::value() {
 				eat(Token::LPARENTHESIS);
 				expression = Builder::expression();
 				eat(Token::RPARENTHESIS);
-				return new FunctionAST(coordinate, name, expression);
+				return arena->create<FunctionAST>(coordinate, name, expression);
 			} else {
-				return new ConstantAST(coordinate, name);
+				return arena->create<ConstantAST>(coordinate, name);
 			}
 		default:
 			throw Exception(this);
@@ -470,7 +516,7 @@ GateAST *Builder::gate() {
 	qregs = Builder::qregs();
 	eat(Token::SEMICOLON);
 
-	return new GateAST(coordinate, name, expressions, qregs);
+	return arena->create<GateAST>(coordinate, name, expressions, qregs);
 }
 
 BarrierAST *Builder::barrier() {
@@ -483,7 +529,7 @@ BarrierAST *Builder::barrier() {
 	qregs = Builder::qregs();
 	eat(Token::SEMICOLON);
 
-	return new BarrierAST(coordinate, qregs);
+	return arena->create<BarrierAST>(coordinate, qregs);
 }
 
 ResetAST *Builder::reset() {
@@ -496,7 +542,7 @@ ResetAST *Builder::reset() {
 	qreg = Builder::qreg();
 	eat(Token::SEMICOLON);
 
-	return new ResetAST(coordinate, qreg);
+	return arena->create<ResetAST>(coordinate, qreg);
 }
 
 MeasureAST *Builder::measure() {
@@ -512,7 +558,7 @@ MeasureAST *Builder::measure() {
 	creg = Builder::creg();
 	eat(Token::SEMICOLON);
 
-	return new MeasureAST(coordinate, qreg, creg);
+	return arena->create<MeasureAST>(coordinate, qreg, creg);
 }
 
 ConditionAST *Builder::condition() {
@@ -531,7 +577,7 @@ ConditionAST *Builder::condition() {
 	eat(Token::RPARENTHESIS);
 	command = condition_command();
 
-	return new ConditionAST(coordinate, creg, integer, command);
+	return arena->create<ConditionAST>(coordinate, creg, integer, command);
 }
 
 
@@ -9,6 +9,9 @@
 #endif
 
 #include <sstream>
+#include <map>
+#include <mutex>
+#include <filesystem>
 #include "AST.h"
 #include "../tokenizer/Tokenizer.h"
 #include "../tokenizer/Token.h"
@@ -34,23 +37,46 @@ namespace ast {
 
 	private:
 
+		/**
+		 * The commands of an included file, and the state of the file when they were built.
+		 */
+		struct CachedInclude {
+			std::filesystem::file_time_type time;
+			std::uintmax_t size;
+			IncludeAST::Commands commands;
+		};
+
+		static std::mutex includeCacheMutex;
+		static std::map<std::string, CachedInclude> includeCache;
+
 		int pos = 0;
-		std::vector<Token> tokens;
+		const std::vector<Token> &tokens;
+		Arena *arena;
+
+		/**
+		 * Tokenizes the given file and builds it's commands. If the file was already
+		 * built (by any program) and it hasn't changed since, the cached commands are returned.
+		 *
+		 * @param file The path of the file
+		 * @return The commands of the file
+		 */
+		static IncludeAST::Commands buildInclude(const std::string &file);
 
 		/**
 		 * Creates a builder that can build an abstract syntax tree
 		 * from the given tokens.
 		 *
 		 * @param tokens The tokens from which the tree will be built
+		 * @param arena The arena the nodes of the tree are created in
 		 */
-		explicit Builder(std::vector<Token> &tokens);
+		Builder(const std::vector<Token> &tokens, Arena *arena);
 
 		/**
 		 * Returns the current token.
 		 *
 		 * @return The current token
 		 */
-		Token get() const;
+		const Token &get() const;
 
 		/**
 		 * Returns the current token. If the given type doesn't match
@@ -74,6 +100,7 @@ namespace ast {
 		 * Builds an include AST from the next tokens and tokenizes
 		 * the included file. After tokenizing, it build an abstract
 		 * syntax tree from the tokens and stores it.
+		 * Files that were already included are only built again if they changed.
 		 *
 		 * @return The built AST
 		 */
@@ -241,11 +268,18 @@ namespace ast {
 		 * Creates an abstract syntax tree from the given tokens and
 		 * returns it's root node (the program AST). It temporarily creates
 		 * a builder object but discard it when the method returns.
+		 * The nodes are created in an arena owned by the program AST.
 		 *
 		 * @param tokens The token from which the tree is created
 		 * @return The root node of the tree
 		 */
-		static ProgramAST *build(std::vector<Token> tokens);
+		static ProgramAST *build(const std::vector<Token> &tokens);
+
+		/**
+		 * Forgets the commands of the included files built so far.
+		 * The already built trees aren't affected.
+		 */
+		static void clearIncludeCache();
 	};
 }
 
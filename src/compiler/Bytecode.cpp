@@ -0,0 +1,435 @@
+#include <algorithm>
+#include "Bytecode.h"
+
+namespace {
+
+	/**
+	 * Returns the superoperator applying two superoperators one after the other.
+	 * They are indexed by [input][output], so it's the product in the order of their application.
+	 *
+	 * @param first The 4x4 superoperator applied first
+	 * @param second The 4x4 superoperator applied second
+	 * @return The combined 4x4 superoperator
+	 */
+	std::vector<Complex> compose(const Complex *first, const Complex *second) {
+		std::vector<Complex> product(16);
+		for (unsigned long input = 0; input < 4; input++) {
+			for (unsigned long output = 0; output < 4; output++) {
+				Complex sum;
+				for (unsigned long i = 0; i < 4; i++) sum = sum + first[input * 4 + i] * second[i * 4 + output];
+				product[input * 4 + output] = sum;
+			}
+		}
+		return product;
+	}
+}
+
+Bytecode::Bytecode(const std::vector<Instruction *> &instructions, Encoding encoding) :
+		encoding(encoding), fence(0) {
+
+	unsigned long i = 0;
+	while (i < instructions.size()) {
+		Instruction *instruction = instructions[i];
+		if (instruction->getType() != Instruction::CONDITION) {
+			i += add(instructions, i, instructions.size());
+			continue;
+		}
+
+		// The jump is counted in instructions, but some of them may not have an operation,
+		// so it's recomputed after the guarded instructions are added
+		Condition *condition = (Condition *) instruction;
+		unsigned long index = operations.size();
+		operations.push_back({CONDITION, condition->getBits().size(), 0, values.size()});
+		values.insert(values.end(), condition->getBits().begin(), condition->getBits().end());
+		values.push_back(condition->getCriteria());
+		fence = operations.size();
+
+		unsigned long end = std::min(i + 1 + condition->getJump(), (unsigned long) instructions.size());
+		for (i++; i < end;) i += add(instructions, i, end);
+		operations[index].argument = operations.size() - index - 1;
+		fence = operations.size();
+	}
+}
+
+unsigned long Bytecode::add(const std::vector<Instruction *> &instructions, unsigned long index, unsigned long end) {
+	Instruction *instruction = instructions[index];
+	switch (instruction->getType()) {
+		case Instruction::UNITARY: {
+			U *u = (U *) instruction;
+			const Complex (&matrix)[2][2] = u->getMatrix();
+			if (encoding == STABILIZER && u->getShape() != Matrix::IDENTITY) {
+				Tableau::Clifford clifford;
+				if (!Tableau::toClifford(matrix, clifford)) throw std::invalid_argument("not a Clifford gate");
+				operations.push_back({CLIFFORD, u->getQubit(), 0, cliffords.size()});
+				cliffords.push_back(clifford);
+				break;
+			}
+			switch (u->getShape()) {
+				case Matrix::IDENTITY:
+					break;
+				case Matrix::DIAGONAL:
+					operations.push_back({DIAGONAL, u->getQubit(), 0, matrices.size()});
+					matrices.push_back(matrix[0][0]);
+					matrices.push_back(matrix[1][1]);
+					break;
+				case Matrix::ANTI_DIAGONAL:
+					operations.push_back({ANTI_DIAGONAL, u->getQubit(), 0, matrices.size()});
+					matrices.push_back(matrix[0][1]);
+					matrices.push_back(matrix[1][0]);
+					break;
+				case Matrix::GENERAL:
+					operations.push_back({TRANSFORM, u->getQubit(), 0, matrices.size()});
+					matrices.insert(matrices.end(), &matrix[0][0], &matrix[0][0] + 4);
+					break;
+			}
+			break;
+		}
+		case Instruction::CONTROLLED_NOT: {
+			CX *cx = (CX *) instruction;
+			operations.push_back({NOT, cx->getQubit2(), cx->getQubit1(), 0});
+			break;
+		}
+		case Instruction::FUSED: {
+			Unitary *unitary = (Unitary *) instruction;
+			if (encoding == STABILIZER) throw std::invalid_argument("fused gates can't be executed on a tableau");
+			operations.push_back({FUSED, unitary->getQubits().size(), matrices.size(), values.size()});
+			values.insert(values.end(), unitary->getQubits().begin(), unitary->getQubits().end());
+			matrices.insert(matrices.end(), unitary->getMatrix().begin(), unitary->getMatrix().end());
+			break;
+		}
+		case Instruction::BARRIER:
+			break;
+		case Instruction::RESET:
+			operations.push_back({RESET, ((Reset *) instruction)->getQubit(), 0, 0});
+			break;
+		case Instruction::MEASURE: {
+			unsigned long count = 1;
+			while (index + count < end && instructions[index + count]->getType() == Instruction::MEASURE) count++;
+
+			operations.push_back({MEASURE, count, 0, values.size()});
+			for (unsigned long i = 0; i < count; i++) values.push_back(((Measure *) instructions[index + i])->getQubit());
+			for (unsigned long i = 0; i < count; i++) values.push_back(((Measure *) instructions[index + i])->getBit());
+			return count;
+		}
+		case Instruction::CHANNEL: {
+			if (encoding == STABILIZER) throw std::invalid_argument("noise can't be executed on a tableau");
+			Channel *channel = (Channel *) instruction;
+			if (encoding == STATE_VECTOR) {
+				// Scaling the coherences by sqrt(1 - lambda) is the same as a Z error with probability (1 - sqrt(1 - lambda)) / 2
+				double parameter = channel->getParameter();
+				switch (channel->getKind()) {
+					case Channel::DEPOLARIZING:
+						operations.push_back({PAULI_ERROR, channel->getQubit(), 0, matrices.size()});
+						matrices.push_back(Complex(parameter / 4, parameter / 4));
+						matrices.push_back(parameter / 4);
+						break;
+					case Channel::PHASE_DAMPING:
+						operations.push_back({PAULI_ERROR, channel->getQubit(), 0, matrices.size()});
+						matrices.push_back(0);
+						matrices.push_back((1 - sqrt(1 - parameter)) / 2);
+						break;
+					case Channel::AMPLITUDE_DAMPING:
+						operations.push_back({DAMPING, channel->getQubit(), 0, matrices.size()});
+						matrices.push_back(parameter);
+						break;
+				}
+				break;
+			}
+			std::vector<Complex> superoperator = DensityMatrix::getSuperoperator(channel->getOperators());
+
+			// The elements of the last operation are at the end of the matrix pool, so they can be replaced
+			std::vector<Complex> previous;
+			if (operations.size() > fence && operations.back().target == channel->getQubit()) {
+				const Complex *elements = &matrices[operations.back().data];
+				switch (operations.back().opcode) {
+					case TRANSFORM:
+						previous = DensityMatrix::getSuperoperator({elements[0], elements[1], elements[2], elements[3]});
+						break;
+					case DIAGONAL:
+						previous = DensityMatrix::getSuperoperator({elements[0], 0, 0, elements[1]});
+						break;
+					case ANTI_DIAGONAL:
+						previous = DensityMatrix::getSuperoperator({0, elements[0], elements[1], 0});
+						break;
+					case CHANNEL:
+						previous.assign(elements, elements + 16);
+						break;
+					default:
+						break;
+				}
+			}
+			if (!previous.empty()) {
+				superoperator = compose(previous.data(), superoperator.data());
+				matrices.resize(operations.back().data);
+				operations.pop_back();
+			}
+
+			operations.push_back({CHANNEL, channel->getQubit(), 0, matrices.size()});
+			matrices.insert(matrices.end(), superoperator.begin(), superoperator.end());
+			break;
+		}
+		case Instruction::READOUT: {
+			if (encoding == STABILIZER) throw std::invalid_argument("noise can't be executed on a tableau");
+			ReadoutError *readout = (ReadoutError *) instruction;
+			operations.push_back({READOUT, readout->getBit(), 0, matrices.size()});
+			matrices.push_back(Complex(readout->getFlip0(), readout->getFlip1()));
+			break;
+		}
+		case Instruction::CONDITION:
+			throw std::invalid_argument("nested conditions are not supported");
+	}
+	return 1;
+}
+
+template<typename Scalar>
+void Bytecode::execute(BasicEnvironment<Scalar> &env, bool measure) const {
+	// The squared norm of the state, which is only changed by the amplitude damping
+	double norm = 1;
+
+	const Operation *operation = operations.data();
+	const Operation *end = operation + operations.size();
+	for (; operation < end; operation++) {
+		switch (operation->opcode) {
+			case TRANSFORM:
+				env.applyTransform(operation->target, (const Complex (*)[2]) &matrices[operation->data]);
+				break;
+			case DIAGONAL:
+				env.applyDiagonal(operation->target, matrices[operation->data], matrices[operation->data + 1]);
+				break;
+			case ANTI_DIAGONAL:
+				env.applyAntiDiagonal(operation->target, matrices[operation->data], matrices[operation->data + 1]);
+				break;
+			case NOT:
+				env.applyNot(operation->target, 1ul << operation->argument);
+				break;
+			case FUSED:
+				env.applyTransform(&values[operation->data], operation->target, &matrices[operation->argument]);
+				break;
+			case PAULI_ERROR: {
+				const Complex *chances = &matrices[operation->data];
+				double random = env.random();
+				if (random <= chances[0].r) {
+					env.applyNot(operation->target);
+				} else if (random <= chances[0].r + chances[0].i) {
+					env.applyAntiDiagonal(operation->target, Complex(0, 1), Complex(0, -1));
+				} else if (random <= chances[0].r + chances[0].i + chances[1].r) {
+					env.applyDiagonal(operation->target, 1, -1);
+				}
+				break;
+			}
+			case DAMPING: {
+				// The 1 state is scaled by sqrt(1 - gamma), and the qubit decays (it's collapsed to 1
+				// and flipped) with probability gamma * P(1). Without a decay, the state isn't normalized.
+				double gamma = matrices[operation->data].r;
+				if (gamma == 1) {
+					if (norm != 1) env.normalize();
+					norm = 1;
+					unsigned long qubit = operation->target;
+					if (env.measure(&qubit, 1) == 1) env.applyNot(qubit);
+					break;
+				}
+
+				double chance = env.applyDamping(operation->target, sqrt(1 - gamma));
+				if (env.random() * norm <= gamma * chance) {
+					env.collapse(operation->target, 1, (1 - gamma) * chance);
+					env.applyNot(operation->target);
+					norm = 1;
+				} else {
+					norm -= gamma * chance;
+				}
+
+				// The state is normalized before it's coefficients could underflow
+				if (norm < 1e-100) {
+					env.normalize();
+					norm = 1;
+				}
+				break;
+			}
+			case RESET: {
+				// The qubit is measured, and flipped if it was 1
+				if (norm != 1) env.normalize();
+				norm = 1;
+				unsigned long qubit = operation->target;
+				if (env.measure(&qubit, 1) == 1) env.applyNot(qubit);
+				break;
+			}
+			case MEASURE: {
+				if (!measure) break;
+
+				if (norm != 1) env.normalize();
+				norm = 1;
+				const unsigned long *qubits = &values[operation->data];
+				unsigned long result = env.measure(qubits, operation->target);
+				for (unsigned long i = 0; i < operation->target; i++) {
+					env.setBit(qubits[operation->target + i], (result >> i) & 1ul);
+				}
+				break;
+			}
+			case CONDITION: {
+				const unsigned long *bits = &values[operation->data];
+				unsigned long value = 0;
+				for (unsigned long i = 0; i < operation->target; i++) {
+					value += ((unsigned long) env.getBit(bits[i]) << i);
+				}
+
+				if (value != bits[operation->target]) operation += operation->argument;
+				break;
+			}
+			case READOUT: {
+				if (!measure) break;
+
+				const Complex &flips = matrices[operation->data];
+				unsigned int value = env.getBit(operation->target);
+				if (env.random() <= (value ? flips.i : flips.r)) env.setBit(operation->target, value ^ 1u);
+				break;
+			}
+			default:
+				throw std::logic_error("a stabilizer or density matrix bytecode can't be executed on a state vector");
+		}
+	}
+	if (norm != 1) env.normalize();
+}
+
+template void Bytecode::execute(Environment &env, bool measure) const;
+template void Bytecode::execute(SingleEnvironment &env, bool measure) const;
+
+void Bytecode::execute(Tableau &tableau) const {
+	const Operation *operation = operations.data();
+	const Operation *end = operation + operations.size();
+	for (; operation < end; operation++) {
+		switch (operation->opcode) {
+			case CLIFFORD:
+				tableau.applyClifford(operation->target, cliffords[operation->data]);
+				break;
+			case NOT:
+				tableau.applyNot(operation->target, operation->argument);
+				break;
+			case RESET:
+				tableau.resetQubit(operation->target);
+				break;
+			case MEASURE: {
+				const unsigned long *qubits = &values[operation->data];
+				for (unsigned long i = 0; i < operation->target; i++) {
+					tableau.setBit(qubits[operation->target + i], tableau.measure(qubits[i]));
+				}
+				break;
+			}
+			case CONDITION: {
+				const unsigned long *bits = &values[operation->data];
+				unsigned long value = 0;
+				for (unsigned long i = 0; i < operation->target; i++) {
+					value += ((unsigned long) tableau.getBit(bits[i]) << i);
+				}
+
+				if (value != bits[operation->target]) operation += operation->argument;
+				break;
+			}
+			default:
+				throw std::logic_error("a state vector bytecode can't be executed on a tableau");
+		}
+	}
+}
+
+void Bytecode::execute(MatrixProductState &state, bool measure) const {
+	const Operation *operation = operations.data();
+	const Operation *end = operation + operations.size();
+	for (; operation < end; operation++) {
+		switch (operation->opcode) {
+			case TRANSFORM:
+				state.applyTransform(operation->target, (const Complex (*)[2]) &matrices[operation->data]);
+				break;
+			case DIAGONAL:
+				state.applyDiagonal(operation->target, matrices[operation->data], matrices[operation->data + 1]);
+				break;
+			case ANTI_DIAGONAL:
+				state.applyAntiDiagonal(operation->target, matrices[operation->data], matrices[operation->data + 1]);
+				break;
+			case NOT:
+				state.applyNot(operation->target, operation->argument);
+				break;
+			case RESET:
+				state.resetQubit(operation->target);
+				break;
+			case MEASURE: {
+				if (!measure) break;
+
+				const unsigned long *qubits = &values[operation->data];
+				for (unsigned long i = 0; i < operation->target; i++) {
+					state.setBit(qubits[operation->target + i], state.measure(qubits[i]));
+				}
+				break;
+			}
+			case CONDITION: {
+				const unsigned long *bits = &values[operation->data];
+				unsigned long value = 0;
+				for (unsigned long i = 0; i < operation->target; i++) {
+					value += ((unsigned long) state.getBit(bits[i]) << i);
+				}
+
+				if (value != bits[operation->target]) operation += operation->argument;
+				break;
+			}
+			default:
+				throw std::logic_error("only single qubit gates and CX gates without noise can be executed on a matrix product state");
+		}
+	}
+}
+
+void Bytecode::execute(DensityMatrix &state, bool measure) const {
+	const Operation *operation = operations.data();
+	const Operation *end = operation + operations.size();
+	for (; operation < end; operation++) {
+		switch (operation->opcode) {
+			case TRANSFORM:
+				state.applyTransform(operation->target, (const Complex (*)[2]) &matrices[operation->data]);
+				break;
+			case DIAGONAL:
+				state.applyDiagonal(operation->target, matrices[operation->data], matrices[operation->data + 1]);
+				break;
+			case ANTI_DIAGONAL:
+				state.applyAntiDiagonal(operation->target, matrices[operation->data], matrices[operation->data + 1]);
+				break;
+			case NOT:
+				state.applyNot(operation->target, 1ul << operation->argument);
+				break;
+			case FUSED:
+				state.applyTransform(&values[operation->data], operation->target, &matrices[operation->argument]);
+				break;
+			case CHANNEL:
+				state.applyChannel(operation->target, &matrices[operation->data]);
+				break;
+			case RESET:
+				state.resetQubit(operation->target);
+				break;
+			case MEASURE: {
+				if (!measure) break;
+
+				const unsigned long *qubits = &values[operation->data];
+				for (unsigned long i = 0; i < operation->target; i++) {
+					state.setBit(qubits[operation->target + i], state.measure(qubits[i]));
+				}
+				break;
+			}
+			case READOUT: {
+				if (!measure) break;
+
+				const Complex &flips = matrices[operation->data];
+				unsigned int value = state.getBit(operation->target);
+				if (state.random() <= (value ? flips.i : flips.r)) state.setBit(operation->target, value ^ 1u);
+				break;
+			}
+			case CONDITION: {
+				const unsigned long *bits = &values[operation->data];
+				unsigned long value = 0;
+				for (unsigned long i = 0; i < operation->target; i++) {
+					value += ((unsigned long) state.getBit(bits[i]) << i);
+				}
+
+				if (value != bits[operation->target]) operation += operation->argument;
+				break;
+			}
+			default:
+				throw std::logic_error("only a density matrix bytecode can be executed on a density matrix");
+		}
+	}
+}
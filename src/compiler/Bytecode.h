@@ -0,0 +1,152 @@
+#ifndef QUANTUMSIMULATOR_BYTECODE_H
+#define QUANTUMSIMULATOR_BYTECODE_H
+
+
+#include <vector>
+#include "Instruction.h"
+#include "../math/Tableau.h"
+#include "../math/MatrixProductState.h"
+#include "../math/DensityMatrix.h"
+
+namespace compiler {
+
+	/**
+	 * The executable form of a program. The instructions are flattened into one contiguous
+	 * array of small operations, and the matrices and qubit lists they refer to are stored
+	 * in separate pools, so the execution doesn't have to chase pointers or make virtual calls.
+	 * Instructions that do nothing (barriers and identity gates) are left out.
+	 *
+	 * Programs made of Clifford gates can also be encoded for a stabilizer tableau,
+	 * where the gates are stored as their action on the Pauli operators.
+	 * The state vector encoding can also be executed on a matrix product state,
+	 * as long as it has no fused gates or noise. Noise channels are encoded as
+	 * superoperators for a density matrix, and as the probabilities of their
+	 * Kraus operators for a state vector, where they are drawn in every shot.
+	 */
+	class Bytecode {
+	public:
+
+		/**
+		 * The possible ways of encoding the instructions (the kind of state they are executed on).
+		 */
+		enum Encoding {
+			STATE_VECTOR, STABILIZER, DENSITY_MATRIX
+		};
+
+		/**
+		 * The possible operations.
+		 */
+		enum Opcode : unsigned char {
+			TRANSFORM, DIAGONAL, ANTI_DIAGONAL, NOT, FUSED, RESET, MEASURE, CONDITION, CLIFFORD, CHANNEL, PAULI_ERROR, DAMPING, READOUT
+		};
+
+		/**
+		 * An operation and it's operands. The meaning of the operands depends on the opcode:
+		 *
+		 * TRANSFORM: target is the qubit, data is the offset of the 2x2 matrix in the matrix pool
+		 * DIAGONAL: target is the qubit, data is the offset of the 2 diagonal elements
+		 * ANTI_DIAGONAL: target is the qubit, data is the offset of the 2 anti-diagonal elements
+		 * NOT: target is the flipped qubit, argument is the control qubit
+		 * FUSED: target is the number of qubits, data is the offset of the qubits in the value pool
+		 *        and argument is the offset of the matrix in the matrix pool
+		 * RESET: target is the qubit
+		 * MEASURE: target is the number of measured qubits, data is the offset of the qubits
+		 *          (followed by the bits) in the value pool
+		 * CONDITION: target is the number of bits, data is the offset of the bits (followed by the criteria)
+		 *            in the value pool and argument is the number of operations to skip if it's not met
+		 * CLIFFORD: target is the qubit, data is the offset of the gate's action in the clifford pool
+		 * CHANNEL: target is the qubit, data is the offset of the 4x4 superoperator in the matrix pool
+		 * PAULI_ERROR: target is the qubit, data is the offset of the probabilities of the X, Y and Z errors
+		 *              (the real and imaginary part of the first element and the real part of the second)
+		 * DAMPING: target is the qubit, data is the offset of the damping probability (the real part)
+		 * READOUT: target is the bit, data is the offset of the error probabilities
+		 *          (reading 0 as 1 and 1 as 0, as the real and imaginary part) in the matrix pool
+		 */
+		struct Operation {
+			Opcode opcode;
+			unsigned long target;
+			unsigned long argument;
+			unsigned long data;
+		};
+
+	private:
+
+		std::vector<Operation> operations;
+		std::vector<Complex> matrices;
+		std::vector<unsigned long> values;
+		std::vector<Tableau::Clifford> cliffords;
+		Encoding encoding;
+
+		/**
+		 * The index of the first operation a channel can be merged into.
+		 * The operations before it may be skipped by a condition the channel isn't guarded by.
+		 */
+		unsigned long fence;
+
+		/**
+		 * Appends the operation of the next instruction (if it does something).
+		 * Consecutive measurements are merged into one operation, which measures the qubits at once,
+		 * and a channel is merged with the single qubit gate or channel it follows on the same qubit,
+		 * so that a noisy gate only takes one pass over the density matrix.
+		 * For a state vector, depolarizing and phase damping are both mixtures of Pauli errors.
+		 *
+		 * @param instructions The instructions
+		 * @param index The index of the next instruction
+		 * @param end The index after the last instruction that can be merged
+		 * @return The number of instructions used
+		 */
+		unsigned long add(const std::vector<Instruction *> &instructions, unsigned long index, unsigned long end);
+
+	public:
+
+		/**
+		 * Creates the bytecode of the given instructions, for a state vector, a stabilizer tableau or a density matrix.
+		 * The instructions of a stabilizer bytecode must be Clifford gates, resets, measurements and conditions.
+		 *
+		 * @param instructions The instructions
+		 * @param encoding The kind of state the instructions are encoded for
+		 */
+		explicit Bytecode(const std::vector<Instruction *> &instructions, Encoding encoding = STATE_VECTOR);
+
+		/**
+		 * Executes the operations on the given environment (of either precision). The noise channels
+		 * are executed as one of their Kraus operators, drawn with the environment's random number generator.
+		 * The environment is left normalized. If measuring is disabled, the measurements are skipped.
+		 *
+		 * @param env The quantum environment
+		 * @param measure Enables the measurements
+		 */
+		template<typename Scalar>
+		void execute(BasicEnvironment<Scalar> &env, bool measure = true) const;
+
+		/**
+		 * Executes the operations of a stabilizer bytecode on the given tableau.
+		 *
+		 * @param tableau The stabilizer tableau
+		 */
+		void execute(Tableau &tableau) const;
+
+		/**
+		 * Executes the operations of a state vector bytecode without fused gates on the given matrix product state.
+		 * If measuring is disabled, the measurements are skipped.
+		 *
+		 * @param state The matrix product state
+		 * @param measure Enables the measurements
+		 */
+		void execute(MatrixProductState &state, bool measure = true) const;
+
+		/**
+		 * Executes the operations of a state vector bytecode on the given density matrix.
+		 * If measuring is disabled, the measurements and the readout errors are skipped.
+		 *
+		 * @param state The density matrix
+		 * @param measure Enables the measurements
+		 */
+		void execute(DensityMatrix &state, bool measure = true) const;
+	};
+}
+
+using namespace compiler;
+
+
+#endif //QUANTUMSIMULATOR_BYTECODE_H
@@ -35,18 +35,70 @@ const std::map<std::string, double> &Compiler::GateScope::getLocalConstants() co
 
 
 
-Program *Compiler::compile(ProgramAST *program) {
+const unsigned long Compiler::MAX_STATE_VECTOR_QUBITS;
+const unsigned long Compiler::MAX_DENSITY_MATRIX_QUBITS;
+
+Program *Compiler::compile(ProgramAST *program, bool optimize, bool matrixProductState, const NoiseModel *noise,
+                           bool trajectories, StabilizerMode stabilizer) {
+	if (noise != nullptr && matrixProductState) {
+		throw Exception(program->getCoordinate(), "Noise can't be simulated by a matrix product state");
+	}
+	if (stabilizer == ALWAYS && (noise != nullptr || matrixProductState)) {
+		throw Exception(program->getCoordinate(), "Only a noiseless program can be simulated by a stabilizer tableau");
+	}
+
 	Compiler compiler;
+	compiler.noise = noise;
 	std::vector<Instruction *> instructions = compiler.compileProgram(program);
 
+	// A state vector samples the terminal measurements from a single execution,
+	// which is faster than executing every shot on a tableau, as long as the state vector fits
+	Program::Backend backend = Program::STATE_VECTOR;
+	if (stabilizer != NEVER && isClifford(instructions)) {
+		if (stabilizer == ALWAYS || compiler.qubitCount > MAX_STATE_VECTOR_QUBITS ||
+		    !Program::isSampleable(instructions, compiler.bitCount, compiler.qubitCount, Program::STATE_VECTOR)) {
+			backend = Program::STABILIZER;
+		}
+	} else if (stabilizer == ALWAYS) {
+		for (Instruction *instruction : instructions) delete instruction;
+		throw Exception(program->getCoordinate(), "Only a program made of Clifford gates can be simulated by a stabilizer tableau");
+	}
+
+	// The tableau applies the gates one by one, so they aren't fused,
+	// and the matrix product state can only apply single qubit gates and CX gates
+	if (matrixProductState) backend = Program::MATRIX_PRODUCT_STATE;
+	if (noise != nullptr) {
+		bool densityMatrix = !trajectories && compiler.qubitCount <= MAX_DENSITY_MATRIX_QUBITS;
+		backend = densityMatrix ? Program::DENSITY_MATRIX : Program::STATE_VECTOR;
+	}
+	if (optimize && (backend == Program::STATE_VECTOR || backend == Program::DENSITY_MATRIX)) {
+		instructions = Optimizer::optimize(instructions, compiler.qubitCount);
+	} else if (optimize && backend == Program::MATRIX_PRODUCT_STATE) {
+		instructions = Optimizer::optimize(instructions, compiler.qubitCount, 1);
+	}
+
 	return new Program(
 			compiler.bitCount,
 			compiler.qubitCount,
 			compiler.cregIdMap,
-			instructions
+			instructions,
+			backend
 	);
 }
 
+bool Compiler::isClifford(const std::vector<Instruction *> &instructions) {
+	for (Instruction *instruction : instructions) {
+		if (instruction->getType() == Instruction::FUSED) return false;
+		if (instruction->getType() == Instruction::CHANNEL || instruction->getType() == Instruction::READOUT) return false;
+		if (instruction->getType() != Instruction::UNITARY) continue;
+
+		U *u = (U *) instruction;
+		Tableau::Clifford clifford;
+		if (u->getShape() != Matrix::IDENTITY && !Tableau::toClifford(u->getMatrix(), clifford)) return false;
+	}
+	return true;
+}
+
 
 
 std::vector<Instruction *> Compiler::compileProgram(const ProgramAST *program) {
@@ -228,7 +280,12 @@ std::vector<Instruction *> Compiler::compileGate(const GateAST *gate, bool neste
 
 		if (native) {
 			if (gate->getName() == "U") {
-				instructions.push_back(new U(parameterValues[0], parameterValues[1], parameterValues[2], arguments[0]));
+				U *u = new U(parameterValues[0], parameterValues[1], parameterValues[2], arguments[0]);
+				if (u->getShape() == Matrix::IDENTITY) {
+					delete u;
+				} else {
+					instructions.push_back(u);
+				}
 			} else if (gate->getName() == "CX") {
 				instructions.push_back(new CX(arguments[0], arguments[1]));
 			}
@@ -258,6 +315,14 @@ std::vector<Instruction *> Compiler::compileGate(const GateAST *gate, bool neste
 				instructions.insert(instructions.end(), compiled.begin(), compiled.end());
 			}
 		}
+
+		// The built in gates are noisy at every level, the declared gates only when called from the program
+		if (noise != nullptr && (native || !nested)) {
+			for (unsigned long qubit : arguments) {
+				std::vector<Instruction *> channels = noise->getChannels(gate->getName(), qubit);
+				instructions.insert(instructions.end(), channels.begin(), channels.end());
+			}
+		}
 	}
 
 	return instructions;
@@ -307,12 +372,24 @@ std::vector<Instruction *> Compiler::compileMeasure(const MeasureAST *measure) {
 		instructions.push_back(new Measure(qregIds[i], cregIds[i]));
 	}
 
+	// The readout errors are added after the measurements, so that those can still be executed together
+	if (noise != nullptr) {
+		for (int i = 0; i < qregIds.size(); i++) {
+			Instruction *readout = noise->getReadoutError(qregIds[i], cregIds[i]);
+			if (readout != nullptr) instructions.push_back(readout);
+		}
+	}
+
 	return instructions;
 }
 
 std::vector<Instruction *> Compiler::compileCondition(const ConditionAST *condition) {
 	std::vector<Instruction *> instructions;
 	std::vector<unsigned long> bitIds = getCRegIds(condition->getReg());
+	// The register's value is compared as a 64 bit integer
+	if (bitIds.size() > 64) {
+		throw Exception(condition->getCoordinate(), "Only registers of at most 64 bits can be compared");
+	}
 
 	AST *command = condition->getCommand();
 	std::vector<Instruction *> compiled;
@@ -7,6 +7,8 @@
 #include "../math/Environment.h"
 #include "Instruction.h"
 #include "Program.h"
+#include "Optimizer.h"
+#include "NoiseModel.h"
 
 namespace compiler {
 
@@ -16,6 +18,27 @@ namespace compiler {
 	class Compiler {
 	public:
 
+		/**
+		 * When a program made of Clifford gates is simulated by a stabilizer tableau:
+		 * automatically (if it can't be sampled from a single state vector execution,
+		 * or the state vector would be too big), always, or never.
+		 */
+		enum StabilizerMode {
+			AUTOMATIC, ALWAYS, NEVER
+		};
+
+		/**
+		 * The largest number of qubits a Clifford program is automatically simulated by a state vector with
+		 * (2^28 amplitudes take 4 GiB).
+		 */
+		static const unsigned long MAX_STATE_VECTOR_QUBITS = 28;
+
+		/**
+		 * The largest number of qubits a noisy program is simulated by a density matrix with
+		 * (4^14 elements take 4 GiB). Bigger programs draw the noise in every shot on a state vector instead.
+		 */
+		static const unsigned long MAX_DENSITY_MATRIX_QUBITS = MAX_STATE_VECTOR_QUBITS / 2;
+
 		/**
 		 * A runtime error, thrown when an error happens during compilation.
 		 */
@@ -66,6 +89,7 @@ namespace compiler {
 		std::map<std::string, std::vector<unsigned long>> cregIdMap;
 		std::map<std::string, std::vector<unsigned long>> qregIdMap;
 		std::map<std::string, const GateDeclarationAST *> gates;
+		const NoiseModel *noise = nullptr;
 
 		/**
 		 * Compiles the given program AST's children into a vector of instructions,
@@ -127,6 +151,7 @@ namespace compiler {
 
 		/**
 		 * Compiles a gate AST into a vector of instructions.
+		 * If there is a noise model, the channels of the gate follow each of it's calls.
 		 *
 		 * @param gate The gate AST
 		 * @param nested True if the gate is called from another gate
@@ -155,6 +180,7 @@ namespace compiler {
 
 		/**
 		 * Compiles a measure AST into a an instruction.
+		 * If there is a noise model, the readout errors follow the measurements.
 		 *
 		 * @param measure The measure AST
 		 * @return The compiled instruction (a vector with only one item)
@@ -195,16 +221,39 @@ namespace compiler {
 		 */
 		double getValue(const ExpressionAST *expression, const std::map<std::string, double> &constants);
 
+		/**
+		 * Returns true if every gate of the given instructions is a Clifford gate,
+		 * so they can be simulated by a stabilizer tableau.
+		 *
+		 * @param instructions The instructions
+		 * @return True if the instructions only contain Clifford gates
+		 */
+		static bool isClifford(const std::vector<Instruction *> &instructions);
+
 	public:
 
 		/**
 		 * Compiles the given abstract syntax tree (where the root node is a ProgramAST)
-		 * to a program object.
+		 * to a program object. If every gate is a Clifford gate, the program may be simulated
+		 * by a stabilizer tableau (depending on the stabilizer mode), otherwise it's simulated
+		 * by a state vector, and unless disabled, the consecutive gates are fused by the optimizer. If a matrix product state is
+		 * requested, it's used regardless of the gates, and only single qubit gates are fused.
+		 * If a noise model is given, it's channels and readout errors are added to the instructions,
+		 * and the program is simulated by a density matrix, or by a state vector drawing
+		 * the errors in every shot (one trajectory per shot), if trajectories are requested
+		 * or the program has more than MAX_DENSITY_MATRIX_QUBITS qubits.
 		 *
 		 * @param program The root node of an abstract syntax tree
+		 * @param optimize Enables the optimizer
+		 * @param matrixProductState Simulates the program by a matrix product state
+		 * @param noise The noise model (or null for a noiseless simulation)
+		 * @param trajectories Simulates the noise by sampling trajectories on a state vector
+		 * @param stabilizer When a Clifford program is simulated by a stabilizer tableau
 		 * @return The program containing the compiled instructions
 		 */
-		static Program *compile(ProgramAST *program);
+		static Program *compile(ProgramAST *program, bool optimize = true, bool matrixProductState = false,
+		                        const NoiseModel *noise = nullptr, bool trajectories = false,
+		                        StabilizerMode stabilizer = AUTOMATIC);
 	};
 }
 
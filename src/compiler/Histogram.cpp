@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <stdexcept>
+#include "Histogram.h"
+
+Histogram::Histogram(unsigned long wordCount) : wordCount(wordCount), counts(16, 0), outcomes(16 * wordCount, 0),
+                                                size(0) {
+	if (wordCount == 0) throw std::invalid_argument("an outcome needs at least one word");
+}
+
+unsigned long Histogram::getWordCount() const {
+	return wordCount;
+}
+
+unsigned long Histogram::find(const unsigned long *outcome) const {
+	// Fibonacci hashing spreads the outcomes that only differ in the high bits
+	unsigned long hash = 0;
+	for (unsigned long word = 0; word < wordCount; word++) hash = (hash ^ outcome[word]) * 0x9E3779B97F4A7C15ul;
+
+	unsigned long mask = counts.size() - 1;
+	unsigned long index = hash >> 32ul & mask;
+	while (counts[index] != 0 && !std::equal(outcome, outcome + wordCount, outcomes.begin() + index * wordCount)) {
+		index = (index + 1) & mask;
+	}
+	return index;
+}
+
+void Histogram::grow() {
+	std::vector<unsigned long> oldCounts(counts.size() * 2, 0);
+	std::vector<unsigned long> oldOutcomes(outcomes.size() * 2, 0);
+	std::swap(counts, oldCounts);
+	std::swap(outcomes, oldOutcomes);
+	for (unsigned long slot = 0; slot < oldCounts.size(); slot++) {
+		if (oldCounts[slot] == 0) continue;
+		const unsigned long *outcome = oldOutcomes.data() + slot * wordCount;
+		unsigned long index = find(outcome);
+		counts[index] = oldCounts[slot];
+		std::copy(outcome, outcome + wordCount, outcomes.begin() + index * wordCount);
+	}
+}
+
+void Histogram::add(const unsigned long *outcome, unsigned long count) {
+	if (count == 0) return;
+
+	unsigned long index = find(outcome);
+	if (counts[index] == 0) {
+		// The table is kept at most half full, so the probe sequences stay short
+		if (2 * (size + 1) > counts.size()) {
+			grow();
+			index = find(outcome);
+		}
+		std::copy(outcome, outcome + wordCount, outcomes.begin() + index * wordCount);
+		size++;
+	}
+	counts[index] += count;
+}
+
+void Histogram::add(unsigned long outcome, unsigned long count) {
+	if (wordCount == 1) {
+		add(&outcome, count);
+		return;
+	}
+
+	std::vector<unsigned long> words(wordCount, 0);
+	words[0] = outcome;
+	add(words.data(), count);
+}
+
+void Histogram::merge(const Histogram &histogram) {
+	if (histogram.wordCount != wordCount) throw std::invalid_argument("the outcomes have different sizes");
+	for (unsigned long slot = 0; slot < histogram.counts.size(); slot++) {
+		if (histogram.counts[slot] != 0) add(histogram.outcomes.data() + slot * wordCount, histogram.counts[slot]);
+	}
+}
+
+unsigned long Histogram::getSize() const {
+	return size;
+}
+
+std::vector<std::pair<std::vector<unsigned long>, unsigned long>> Histogram::getOutcomes() const {
+	std::vector<std::pair<std::vector<unsigned long>, unsigned long>> sorted;
+	sorted.reserve(size);
+	for (unsigned long slot = 0; slot < counts.size(); slot++) {
+		if (counts[slot] == 0) continue;
+		std::vector<unsigned long>::const_iterator outcome = outcomes.begin() + slot * wordCount;
+		sorted.emplace_back(std::vector<unsigned long>(outcome, outcome + wordCount), counts[slot]);
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::vector<unsigned long>, unsigned long> &a,
+	                                           const std::pair<std::vector<unsigned long>, unsigned long> &b) {
+		return std::lexicographical_compare(a.first.rbegin(), a.first.rend(), b.first.rbegin(), b.first.rend());
+	});
+	return sorted;
+}
@@ -0,0 +1,106 @@
+#ifndef QUANTUMSIMULATOR_HISTOGRAM_H
+#define QUANTUMSIMULATOR_HISTOGRAM_H
+
+
+#include <vector>
+#include <utility>
+
+namespace compiler {
+
+	/**
+	 * Counts how many times each outcome (the values of the real bits) occurred.
+	 * Only the observed outcomes are stored, in an open addressing hash table,
+	 * so the memory depends on the number of shots instead of the number of bits.
+	 * An outcome is a fixed number of 64 bit words (the i-th bit is bit i % 64 of word i / 64),
+	 * so any number of real bits can be stored.
+	 */
+	class Histogram {
+	private:
+
+		unsigned long wordCount;
+
+		/**
+		 * The counts of the slots of the table. Slots with 0 count are empty.
+		 */
+		std::vector<unsigned long> counts;
+
+		/**
+		 * The outcomes of the slots of the table, wordCount words each.
+		 */
+		std::vector<unsigned long> outcomes;
+
+		unsigned long size;
+
+		/**
+		 * Returns the slot of the given outcome, or the empty slot where it should be inserted.
+		 *
+		 * @param outcome The words of the outcome
+		 * @return The index of the slot
+		 */
+		unsigned long find(const unsigned long *outcome) const;
+
+		/**
+		 * Doubles the capacity of the table and reinserts the outcomes.
+		 */
+		void grow();
+
+	public:
+
+		/**
+		 * Creates an empty histogram of outcomes made of the given number of words.
+		 *
+		 * @param wordCount The number of 64 bit words of an outcome
+		 */
+		explicit Histogram(unsigned long wordCount = 1);
+
+		/**
+		 * Returns the number of 64 bit words of an outcome.
+		 *
+		 * @return The word count
+		 */
+		unsigned long getWordCount() const;
+
+		/**
+		 * Adds the given count to an outcome.
+		 *
+		 * @param outcome The words of the outcome
+		 * @param count The number of new occurrences
+		 */
+		void add(const unsigned long *outcome, unsigned long count = 1);
+
+		/**
+		 * Adds the given count to an outcome whose bits above the first 64 are all 0.
+		 *
+		 * @param outcome The first word of the outcome
+		 * @param count The number of new occurrences
+		 */
+		void add(unsigned long outcome, unsigned long count = 1);
+
+		/**
+		 * Adds the counts of another histogram (with the same word count) to this one.
+		 *
+		 * @param histogram The other histogram
+		 */
+		void merge(const Histogram &histogram);
+
+		/**
+		 * Returns the number of different outcomes observed.
+		 *
+		 * @return The number of outcomes
+		 */
+		unsigned long getSize() const;
+
+		/**
+		 * Returns the observed outcomes (as their words) and their counts,
+		 * ordered by the outcomes, the last word being the most significant.
+		 *
+		 * @return The outcome-count pairs
+		 */
+		std::vector<std::pair<std::vector<unsigned long>, unsigned long>> getOutcomes() const;
+	};
+}
+
+using namespace compiler;
+
+
+#endif //QUANTUMSIMULATOR_HISTOGRAM_H
@@ -1,27 +1,52 @@
 #include "Instruction.h"
 
+Instruction::Instruction(Type type) : type(type) {
+
+}
+
 Instruction::~Instruction() {
 
 }
 
+Instruction::Type Instruction::getType() const {
+	return type;
+}
+
 // U
 
 U::U(double theta, double phi, double lambda, unsigned long qubit) :
-		theta(theta), phi(phi), lambda(lambda), qubit(qubit) {
+		Instruction(UNITARY), theta(theta), phi(phi), lambda(lambda), qubit(qubit) {
 
+	initialize();
 }
 
-unsigned long U::print(std::ostream &out, bool qe) {
-	out << "u";
-	if (qe) out << "3";
+U::U(const Complex matrix[2][2], unsigned long qubit) :
+		Instruction(UNITARY), qubit(qubit) {
+
+	// The matrix is indexed as matrix[input][output], so matrix[0][1] is the bottom left element
+	double cosine = matrix[0][0].length();
+	double sine = matrix[0][1].length();
+	double sum = 0;
+	double difference = 0;
+	if (cosine > Matrix::EPSILON) sum = matrix[1][1].argument() - matrix[0][0].argument();
+	if (sine > Matrix::EPSILON) difference = matrix[0][1].argument() - (-matrix[1][0]).argument();
+
+	// The angles are only known modulo 2 pi, which leaves the global phase implied by the diagonal
+	// and the one implied by the anti-diagonal ambiguous by pi, so they have to be matched
+	if (cosine > Matrix::EPSILON && sine > Matrix::EPSILON) {
+		double diagonalPhase = (matrix[1][1].argument() + matrix[0][0].argument()) / 2;
+		double antiDiagonalPhase = (matrix[0][1].argument() + (-matrix[1][0]).argument()) / 2;
+		if (cos(diagonalPhase - antiDiagonalPhase) < 0) difference += 2 * M_PI;
+	}
 
-	out << " (" << theta << ", " << phi << ", " << lambda << ") ";
-	out << "q[" << qubit << "]";
-	out << ";" << std::endl;
-	return 0;
+	theta = 2 * atan2(sine, cosine);
+	phi = (sum + difference) / 2;
+	lambda = (sum - difference) / 2;
+
+	initialize();
 }
 
-unsigned long U::execute(Environment &env) {
+void U::initialize() {
 	double c = cos(theta / 2);
 	double s = sin(theta / 2);
 
@@ -30,22 +55,52 @@ unsigned long U::execute(Environment &env) {
 			{-(phi - lambda) / 2, (phi + lambda) / 2}
 	};
 
-	Complex matrix[2][2] {
-			{Complex(cos(exp[0][0]) * c, sin(exp[0][0]) * c), Complex(cos(exp[0][1]) * s, sin(exp[0][1]) * s)},
-			{Complex(-cos(exp[1][0]) * s, -sin(exp[1][0]) * s), Complex(cos(exp[1][1]) * c, sin(exp[1][1]) * c)}
-	};
+	matrix[0][0] = Complex(cos(exp[0][0]) * c, sin(exp[0][0]) * c);
+	matrix[0][1] = Complex(cos(exp[0][1]) * s, sin(exp[0][1]) * s);
+	matrix[1][0] = Complex(-cos(exp[1][0]) * s, -sin(exp[1][0]) * s);
+	matrix[1][1] = Complex(cos(exp[1][1]) * c, sin(exp[1][1]) * c);
+
+	shape = Matrix::getShape(matrix);
+	if (shape == Matrix::DIAGONAL || shape == Matrix::ANTI_DIAGONAL) Matrix::removeGlobalPhase(matrix);
+}
+
+unsigned long U::getQubit() const {
+	return qubit;
+}
+
+Matrix::Shape U::getShape() const {
+	return shape;
+}
+
+const Complex (&U::getMatrix() const)[2][2] {
+	return matrix;
+}
+
+unsigned long U::print(std::ostream &out, bool qe) {
+	out << "u";
+	if (qe) out << "3";
 
-	env.applyTransform(qubit, matrix);
+	out << " (" << theta << ", " << phi << ", " << lambda << ") ";
+	out << "q[" << qubit << "]";
+	out << ";" << std::endl;
 	return 0;
 }
 
 // CX
 
 CX::CX(unsigned long qubit1, unsigned long qubit2) :
-		qubit1(qubit1), qubit2(qubit2) {
+		Instruction(CONTROLLED_NOT), qubit1(qubit1), qubit2(qubit2) {
 
 }
 
+unsigned long CX::getQubit1() const {
+	return qubit1;
+}
+
+unsigned long CX::getQubit2() const {
+	return qubit2;
+}
+
 unsigned long CX::print(std::ostream &out, bool qe) {
 	out << "cx";
 
@@ -57,23 +112,48 @@ unsigned long CX::print(std::ostream &out, bool qe) {
 	return 0;
 }
 
-unsigned long CX::execute(Environment &env) {
-	Complex matrix[4][4] = {
-			{1, 0, 0, 0},
-			{0, 0, 0, 1},
-			{0, 0, 1, 0},
-			{0, 1, 0, 0}
-	};
+// UNITARY
+
+Unitary::Unitary(const std::vector<unsigned long> &qubits, const std::vector<Complex> &matrix) :
+		Instruction(FUSED), qubits(qubits), matrix(matrix) {
 
-	env.applyTransform(qubit1, qubit2, matrix);
+}
+
+const std::vector<unsigned long> &Unitary::getQubits() const {
+	return qubits;
+}
+
+const std::vector<Complex> &Unitary::getMatrix() const {
+	return matrix;
+}
+
+unsigned long Unitary::print(std::ostream &out, bool qe) {
+	if (qe) out << "// fused gates are not supported in the Quantum Experience ";
+	out << "unitary";
+
+	out << " (";
+	for (unsigned long i = 0; i < matrix.size(); i++) {
+		if (i != 0) out << ", ";
+		out << matrix[i];
+	}
+	out << ") ";
+	for (unsigned long i = 0; i < qubits.size(); i++) {
+		if (i != 0) out << ", ";
+		out << "q[" << qubits[i] << "]";
+	}
+	out << ";" << std::endl;
 	return 0;
 }
 
 // BARRIER
 
 Barrier::Barrier(unsigned long qubit) :
-		qubit(qubit) {
+		Instruction(BARRIER), qubit(qubit) {
+
+}
 
+unsigned long Barrier::getQubit() const {
+	return qubit;
 }
 
 unsigned long Barrier::print(std::ostream &out, bool qe) {
@@ -85,17 +165,17 @@ unsigned long Barrier::print(std::ostream &out, bool qe) {
 	return 0;
 }
 
-unsigned long Barrier::execute(Environment &env) {
-	return 0;
-}
-
 // RESET
 
 Reset::Reset(unsigned long qubit) :
-		qubit(qubit) {
+		Instruction(RESET), qubit(qubit) {
 
 }
 
+unsigned long Reset::getQubit() const {
+	return qubit;
+}
+
 unsigned long Reset::print(std::ostream &out, bool qe) {
 	std::cout << "reset";
 
@@ -105,29 +185,19 @@ unsigned long Reset::print(std::ostream &out, bool qe) {
 	return 0;
 }
 
-unsigned long Reset::execute(Environment &env) {
-	Complex matrix[2][2] {
-			{1, 0},
-			{0, 0}
-	};
-
-	env.applyTransform(qubit, matrix);
-	env.normalize();
-	return 0;
-}
-
 // MEASURE
 
-std::mt19937 Measure::mt = std::mt19937(std::random_device()());
-std::uniform_real_distribution<double> Measure::distribution = std::uniform_real_distribution<double>(0, std::nextafter(1, DBL_MAX));
+Measure::Measure(unsigned long qubit, unsigned long bit) :
+		Instruction(MEASURE), qubit(qubit), bit(bit) {
 
-double Measure::random() {
-	return distribution(mt);
 }
 
-Measure::Measure(unsigned long qubit, unsigned long bit) :
-		qubit(qubit), bit(bit) {
+unsigned long Measure::getQubit() const {
+	return qubit;
+}
 
+unsigned long Measure::getBit() const {
+	return bit;
 }
 
 unsigned long Measure::print(std::ostream &out, bool qe) {
@@ -141,27 +211,23 @@ unsigned long Measure::print(std::ostream &out, bool qe) {
 	return 0;
 }
 
-unsigned long Measure::execute(Environment &env) {
-	double random = Measure::random();
-	double chance = env.getQubitChance(qubit);
-	unsigned int result = random > chance ? 0 : 1;
+// CONDITION
 
-	Complex matrix[2][2] {
-			{1 - result, 0},
-			{0, result}
-	};
+Condition::Condition(const std::vector<unsigned long> &bits, unsigned long criteria, unsigned long jump) :
+		Instruction(CONDITION), bits(bits), criteria(criteria), jump(jump) {
 
-	env.applyTransform(qubit, matrix);
-	env.normalize();
-	env.setBit(bit, result);
-	return 0;
 }
 
-// CONDITION
+const std::vector<unsigned long> &Condition::getBits() const {
+	return bits;
+}
 
-Condition::Condition(const std::vector<unsigned long> &bits, unsigned long criteria, unsigned long jump) :
-		bits(bits), criteria(criteria), jump(jump) {
+unsigned long Condition::getCriteria() const {
+	return criteria;
+}
 
+unsigned long Condition::getJump() const {
+	return jump;
 }
 
 unsigned long Condition::print(std::ostream &out, bool qe) {
@@ -180,15 +246,97 @@ unsigned long Condition::print(std::ostream &out, bool qe) {
 	return qe ? jump : 0;
 }
 
-unsigned long Condition::execute(Environment &env) {
-	unsigned long value = 0;
-	for (unsigned long i = 0; i < bits.size(); i++) {
-		value += (env.getBit(bits[i]) << i);
+// CHANNEL
+
+Channel::Channel(Kind kind, double parameter, unsigned long qubit) :
+		Instruction(CHANNEL), kind(kind), parameter(parameter), qubit(qubit) {
+
+	switch (kind) {
+		case DEPOLARIZING: {
+			double identity = sqrt(1 - 0.75 * parameter);
+			double pauli = sqrt(0.25 * parameter);
+			operators = {
+					identity, 0, 0, identity,
+					0, pauli, pauli, 0,
+					0, Complex(0, pauli), Complex(0, -pauli), 0,
+					pauli, 0, 0, -pauli
+			};
+			break;
+		}
+		case AMPLITUDE_DAMPING:
+			operators = {
+					1, 0, 0, sqrt(1 - parameter),
+					0, 0, sqrt(parameter), 0
+			};
+			break;
+		case PHASE_DAMPING:
+			operators = {
+					1, 0, 0, sqrt(1 - parameter),
+					0, 0, 0, sqrt(parameter)
+			};
+			break;
 	}
+}
+
+Channel::Kind Channel::getKind() const {
+	return kind;
+}
 
-	if (value != criteria) {
-		return jump;
-	} else {
-		return 0;
+double Channel::getParameter() const {
+	return parameter;
+}
+
+unsigned long Channel::getQubit() const {
+	return qubit;
+}
+
+const std::vector<Complex> &Channel::getOperators() const {
+	return operators;
+}
+
+unsigned long Channel::print(std::ostream &out, bool qe) {
+	if (qe) out << "// noise is not supported in the Quantum Experience ";
+	switch (kind) {
+		case DEPOLARIZING:
+			out << "depolarizing";
+			break;
+		case AMPLITUDE_DAMPING:
+			out << "amplitude_damping";
+			break;
+		case PHASE_DAMPING:
+			out << "phase_damping";
+			break;
 	}
+
+	out << " (" << parameter << ") ";
+	out << "q[" << qubit << "]";
+	out << ";" << std::endl;
+	return 0;
+}
+
+// READOUT
+
+ReadoutError::ReadoutError(unsigned long bit, double flip0, double flip1) :
+		Instruction(READOUT), bit(bit), flip0(flip0), flip1(flip1) {
+
+}
+
+unsigned long ReadoutError::getBit() const {
+	return bit;
+}
+
+double ReadoutError::getFlip0() const {
+	return flip0;
+}
+
+double ReadoutError::getFlip1() const {
+	return flip1;
+}
+
+unsigned long ReadoutError::print(std::ostream &out, bool qe) {
+	if (qe) out << "// noise is not supported in the Quantum Experience ";
+	out << "readout (" << flip0 << ", " << flip1 << ") ";
+	out << "c[" << bit << "]";
+	out << ";" << std::endl;
+	return 0;
 }
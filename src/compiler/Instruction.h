@@ -3,24 +3,51 @@
 
 
 #include <vector>
-#include <random>
-#include <cfloat>
 #include "../math/Environment.h"
+#include "../math/Matrix.h"
 
 namespace compiler { namespace instructions {
 
 	/**
-	 * The main instruction class. The execute and print methods
-	 * are automatically called by the containing program.
+	 * The main instruction class. The print method is automatically called
+	 * by the containing program, and for the execution, the program
+	 * turns the instructions into bytecode.
 	 */
 	class Instruction {
 	public:
 
+		/**
+		 * The possible instruction types
+		 */
+		enum Type {
+			UNITARY, CONTROLLED_NOT, FUSED, BARRIER, RESET, MEASURE, CONDITION, CHANNEL, READOUT
+		};
+
+	private:
+
+		Type type;
+
+	public:
+
+		/**
+		 * Creates an instruction with the given type.
+		 *
+		 * @param type The instruction's type
+		 */
+		explicit Instruction(Type type);
+
 		/**
 		 * An overridable destructor for the child classes.
 		 */
 		virtual ~Instruction();
 
+		/**
+		 * Returns the instruction's type.
+		 *
+		 * @return The instruction's type
+		 */
+		Type getType() const;
+
 		/**
 		 * Prints the instruction to the given output stream,
 		 * in the given mode.
@@ -30,15 +57,6 @@ namespace compiler { namespace instructions {
 		 * @return The number of lines to be commented out after this line
 		 */
 		virtual unsigned long print(std::ostream &out, bool qe) = 0;
-
-		/**
-		 * Executes the instruction, that may or may not manipulate the given
-		 * quantum environment.
-		 *
-		 * @param env The quantum environment
-		 * @return The number of instructions to jump after this instruction
-		 */
-		virtual unsigned long execute(Environment &env) = 0;
 	};
 
 	/**
@@ -47,6 +65,10 @@ namespace compiler { namespace instructions {
 	 * Gate transformation matrix:
 	 * e^(-i(phi+lambda)/2)*cos(theta/2) -e^(-i(phi-lambda)/2)*sin(theta/2)
 	 * e^(i(phi-lambda)/2)*sin(theta/2)   e^(i(phi+lambda)/2)*cos(theta/2)
+	 *
+	 * The matrix is computed and classified once, when the instruction is created.
+	 * Diagonal and anti-diagonal matrices are executed by their own kernels
+	 * (after removing their global phase), and identity matrices do nothing.
 	 */
 	class U : public Instruction {
 	private:
@@ -56,12 +78,32 @@ namespace compiler { namespace instructions {
 		double lambda;
 		unsigned long qubit;
 
+		Complex matrix[2][2];
+		Matrix::Shape shape;
+
+		/**
+		 * Computes the transformation matrix from the angles and classifies it.
+		 */
+		void initialize();
+
 	public:
 
 		U(double theta, double phi, double lambda, unsigned long qubit);
 
+		/**
+		 * Creates the gate from it's transformation matrix, by decomposing
+		 * the matrix into the three angles (up to a global phase).
+		 *
+		 * @param matrix The unitary transformation (2x2 complex matrix)
+		 * @param qubit The id of the qubit
+		 */
+		U(const Complex matrix[2][2], unsigned long qubit);
+
+		unsigned long getQubit() const;
+		Matrix::Shape getShape() const;
+		const Complex (&getMatrix() const)[2][2];
+
 		unsigned long print(std::ostream &out, bool qe);
-		unsigned long execute(Environment &env);
 	};
 
 	/**
@@ -72,6 +114,8 @@ namespace compiler { namespace instructions {
 	 * 0 0 0 1
 	 * 0 0 1 0
 	 * 0 1 0 0
+	 *
+	 * Since it only permutes the states, it's executed by swapping coefficients.
 	 */
 	class CX : public Instruction {
 	private:
@@ -83,8 +127,31 @@ namespace compiler { namespace instructions {
 
 		CX(unsigned long qubit1, unsigned long qubit2);
 
+		unsigned long getQubit1() const;
+		unsigned long getQubit2() const;
+
+		unsigned long print(std::ostream &out, bool qe);
+	};
+
+	/**
+	 * Applies a unitary transformation to a few qubits. These are only
+	 * created by the optimizer, by fusing consecutive gates acting on the same qubits.
+	 * The i-th qubit is the i-th bit of the matrix indices.
+	 */
+	class Unitary : public Instruction {
+	private:
+
+		std::vector<unsigned long> qubits;
+		std::vector<Complex> matrix;
+
+	public:
+
+		Unitary(const std::vector<unsigned long> &qubits, const std::vector<Complex> &matrix);
+
+		const std::vector<unsigned long> &getQubits() const;
+		const std::vector<Complex> &getMatrix() const;
+
 		unsigned long print(std::ostream &out, bool qe);
-		unsigned long execute(Environment &env);
 	};
 
 	/**
@@ -100,13 +167,14 @@ namespace compiler { namespace instructions {
 
 		explicit Barrier(unsigned long qubit);
 
+		unsigned long getQubit() const;
+
 		unsigned long print(std::ostream &out, bool qe);
-		unsigned long execute(Environment &env);
 	};
 
 	/**
-	 * Resets a qubit to it's initial state and
-	 * modifies all the quantum states accordingly.
+	 * Resets a qubit to it's initial state, by measuring it
+	 * and flipping it if it was 1.
 	 */
 	class Reset : public Instruction {
 	private:
@@ -117,32 +185,112 @@ namespace compiler { namespace instructions {
 
 		explicit Reset(unsigned long qubit);
 
+		unsigned long getQubit() const;
+
 		unsigned long print(std::ostream &out, bool qe);
-		unsigned long execute(Environment &env);
 	};
 
 	/**
 	 * Sets a qubit's value randomly to either 0 or 1 according to it's probability,
 	 * and sets it as the value of a real bit. After that it modifies
-	 * all the quantum states accordingly.
+	 * all the quantum states accordingly. The random numbers are drawn
+	 * from the environment's own generator.
 	 */
 	class Measure : public Instruction {
 	private:
 
-		static std::mt19937 mt;
-		static std::uniform_real_distribution<double> distribution;
-
 		unsigned long qubit;
 		unsigned long bit;
 
-		static double random();
-
 	public:
 
 		Measure(unsigned long qubit, unsigned long bit);
 
+		unsigned long getQubit() const;
+		unsigned long getBit() const;
+
+		unsigned long print(std::ostream &out, bool qe);
+	};
+
+	/**
+	 * Applies a noise channel to a qubit. The channel is given by it's Kraus operators K_i,
+	 * mapping the density matrix to sum K_i * rho * K_i^dagger. These are only created
+	 * by the compiler from a noise model, after the gates acting on the qubit.
+	 *
+	 * Depolarizing: with probability p the qubit is replaced by the completely mixed state
+	 * (K_0 = sqrt(1 - 3p/4) I, K_1,2,3 = sqrt(p/4) X, Y, Z).
+	 * Amplitude damping: the 1 state decays to the 0 state with probability gamma.
+	 * Phase damping: the coherences are scaled by sqrt(1 - lambda), the populations are kept.
+	 */
+	class Channel : public Instruction {
+	public:
+
+		/**
+		 * The supported channels.
+		 */
+		enum Kind {
+			DEPOLARIZING, AMPLITUDE_DAMPING, PHASE_DAMPING
+		};
+
+	private:
+
+		Kind kind;
+		double parameter;
+		unsigned long qubit;
+		std::vector<Complex> operators;
+
+	public:
+
+		/**
+		 * Creates the channel and computes it's Kraus operators.
+		 *
+		 * @param kind The kind of the channel
+		 * @param parameter The probability (or rate) of the error, between 0 and 1
+		 * @param qubit The id of the qubit
+		 */
+		Channel(Kind kind, double parameter, unsigned long qubit);
+
+		Kind getKind() const;
+		double getParameter() const;
+		unsigned long getQubit() const;
+
+		/**
+		 * Returns the Kraus operators, 2x2 matrices (indexed by [input][output] like the gates) one after the other.
+		 *
+		 * @return The Kraus operators
+		 */
+		const std::vector<Complex> &getOperators() const;
+
+		unsigned long print(std::ostream &out, bool qe);
+	};
+
+	/**
+	 * Models a faulty measurement: flips a real bit with a probability depending on it's value.
+	 * These are only created by the compiler from a noise model, after the measurements.
+	 */
+	class ReadoutError : public Instruction {
+	private:
+
+		unsigned long bit;
+		double flip0;
+		double flip1;
+
+	public:
+
+		/**
+		 * Creates the readout error of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @param flip0 The probability of reading 1 if the measured value is 0
+		 * @param flip1 The probability of reading 0 if the measured value is 1
+		 */
+		ReadoutError(unsigned long bit, double flip0, double flip1);
+
+		unsigned long getBit() const;
+		double getFlip0() const;
+		double getFlip1() const;
+
 		unsigned long print(std::ostream &out, bool qe);
-		unsigned long execute(Environment &env);
 	};
 
 	/**
@@ -161,8 +309,11 @@ namespace compiler { namespace instructions {
 
 		Condition(const std::vector<unsigned long> &bits, unsigned long criteria, unsigned long jump);
 
+		const std::vector<unsigned long> &getBits() const;
+		unsigned long getCriteria() const;
+		unsigned long getJump() const;
+
 		unsigned long print(std::ostream &out, bool qe);
-		unsigned long execute(Environment &env);
 	};
 } }
 
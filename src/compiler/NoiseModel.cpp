@@ -0,0 +1,110 @@
+#include <fstream>
+#include <sstream>
+#include "NoiseModel.h"
+
+NoiseModel::Exception::Exception(const std::string &file, unsigned long line, const char *message) noexcept :
+		runtime_error("Error in \"" + file + "\" at line " + std::to_string(line) + ":\n" + message) {
+
+}
+
+
+
+namespace {
+
+	/**
+	 * Parses a probability.
+	 *
+	 * @param word The text of the number
+	 * @param value The probability (set by the function)
+	 * @return True if the text is a number between 0 and 1
+	 */
+	bool parseProbability(const std::string &word, double &value) {
+		try {
+			size_t length;
+			value = std::stod(word, &length);
+			if (length != word.size()) return false;
+		} catch (const std::logic_error &) {
+			return false;
+		}
+		return value >= 0 && value <= 1;
+	}
+}
+
+NoiseModel NoiseModel::load(const std::string &file) {
+	std::ifstream input(file);
+	if (!input) throw std::runtime_error("The file: \"" + file + "\" doesn't exist.");
+
+	NoiseModel model;
+	std::string line;
+	for (unsigned long number = 1; std::getline(input, line); number++) {
+		std::string::size_type comment = line.find('#');
+		if (comment != std::string::npos) line.erase(comment);
+
+		std::vector<std::string> words;
+		std::istringstream stream(line);
+		for (std::string word; stream >> word;) words.push_back(word);
+		if (words.empty()) continue;
+
+		// Every rule ends with two values, so the qubit is given if there are four words
+		const std::string &gate = words[0];
+		long qubit = -1;
+		unsigned long next = 1;
+		if (words.size() == 4) {
+			size_t length = 0;
+			try {
+				qubit = std::stol(words[1], &length);
+			} catch (const std::logic_error &) {
+				length = 0;
+			}
+			if (qubit < 0 || length != words[1].size()) throw Exception(file, number, "Invalid qubit");
+			next = 2;
+		}
+		if (words.size() < next + 2) throw Exception(file, number, "Too few values");
+		if (words.size() > next + 2) throw Exception(file, number, "Too many values");
+
+		if (gate == "readout") {
+			Readout readout {qubit, 0, 0};
+			if (!parseProbability(words[next], readout.flip0) || !parseProbability(words[next + 1], readout.flip1)) {
+				throw Exception(file, number, "Invalid readout error probability");
+			}
+			model.readouts.push_back(readout);
+			continue;
+		}
+
+		Rule rule {gate, qubit, Channel::DEPOLARIZING, 0};
+		if (words[next] == "depolarizing") {
+			rule.kind = Channel::DEPOLARIZING;
+		} else if (words[next] == "amplitude_damping") {
+			rule.kind = Channel::AMPLITUDE_DAMPING;
+		} else if (words[next] == "phase_damping") {
+			rule.kind = Channel::PHASE_DAMPING;
+		} else {
+			throw Exception(file, number, "Unknown channel");
+		}
+		if (!parseProbability(words[next + 1], rule.parameter)) throw Exception(file, number, "Invalid channel probability");
+		model.rules.push_back(rule);
+	}
+
+	return model;
+}
+
+std::vector<Instruction *> NoiseModel::getChannels(const std::string &gate, unsigned long qubit) const {
+	std::vector<Instruction *> channels;
+	for (const Rule &rule : rules) {
+		if (rule.gate != gate && !(rule.gate == "*" && (gate == "U" || gate == "CX"))) continue;
+		if (rule.qubit >= 0 && (unsigned long) rule.qubit != qubit) continue;
+		if (rule.parameter > 0) channels.push_back(new Channel(rule.kind, rule.parameter, qubit));
+	}
+	return channels;
+}
+
+Instruction *NoiseModel::getReadoutError(unsigned long qubit, unsigned long bit) const {
+	const Readout *found = nullptr;
+	for (const Readout &readout : readouts) {
+		if (readout.qubit < 0 && found == nullptr) found = &readout;
+		if (readout.qubit >= 0 && (unsigned long) readout.qubit == qubit) found = &readout;
+	}
+
+	if (found == nullptr || (found->flip0 == 0 && found->flip1 == 0)) return nullptr;
+	return new ReadoutError(bit, found->flip0, found->flip1);
+}
@@ -0,0 +1,96 @@
+#ifndef QUANTUMSIMULATOR_NOISEMODEL_H
+#define QUANTUMSIMULATOR_NOISEMODEL_H
+
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "Instruction.h"
+
+namespace compiler {
+
+	/**
+	 * Describes the errors of a noisy quantum computer: which channels follow the gates
+	 * and how likely the measurements are to be misread. It's loaded from a text file,
+	 * where every line is a rule (and "#" starts a comment):
+	 *
+	 * <gate> [<qubit>] <depolarizing | amplitude_damping | phase_damping> <probability>
+	 * readout [<qubit>] <probability of reading 0 as 1> <probability of reading 1 as 0>
+	 *
+	 * The gate is "U" or "CX" for the built in gates, the name of a declared gate
+	 * for it's calls in the program's body, or "*" for both of the built in gates.
+	 * The qubits are numbered across the registers in the order of their declaration,
+	 * and a rule without a qubit applies to every qubit. Every matching channel rule
+	 * is applied to each argument qubit of the gate, in the order of the file,
+	 * while the readout error of a qubit is given by it's own rule if there is one.
+	 */
+	class NoiseModel {
+	public:
+
+		/**
+		 * A runtime error, thrown when a noise model file is invalid.
+		 */
+		class Exception : public std::runtime_error {
+		public:
+
+			Exception(const std::string &file, unsigned long line, const char *message) noexcept;
+		};
+
+	private:
+
+		/**
+		 * A channel following the gates with the given name on the given qubit (any qubit if it's negative).
+		 */
+		struct Rule {
+			std::string gate;
+			long qubit;
+			Channel::Kind kind;
+			double parameter;
+		};
+
+		/**
+		 * The readout error of the given qubit (any qubit if it's negative).
+		 */
+		struct Readout {
+			long qubit;
+			double flip0;
+			double flip1;
+		};
+
+		std::vector<Rule> rules;
+		std::vector<Readout> readouts;
+
+	public:
+
+		/**
+		 * Loads a noise model from the given file.
+		 *
+		 * @param file The path of the file
+		 * @return The noise model
+		 */
+		static NoiseModel load(const std::string &file);
+
+		/**
+		 * Creates the channels following a gate on one of it's argument qubits.
+		 *
+		 * @param gate The name of the gate
+		 * @param qubit The id of the qubit
+		 * @return The channel instructions (owned by the caller)
+		 */
+		std::vector<Instruction *> getChannels(const std::string &gate, unsigned long qubit) const;
+
+		/**
+		 * Creates the readout error following the measurement of a qubit.
+		 *
+		 * @param qubit The id of the measured qubit
+		 * @param bit The id of the real bit
+		 * @return The readout error instruction (owned by the caller), or null if the qubit is read perfectly
+		 */
+		Instruction *getReadoutError(unsigned long qubit, unsigned long bit) const;
+	};
+}
+
+using namespace compiler;
+
+
+#endif //QUANTUMSIMULATOR_NOISEMODEL_H
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include "Optimizer.h"
+
+/**
+ * Creates the matrix of a transformation that does nothing.
+ *
+ * @param qubitCount The number of qubits the transformation acts on
+ * @return The identity matrix (the rows one after the other)
+ */
+static std::vector<Complex> identity(unsigned long qubitCount) {
+	unsigned long dimension = 1ul << qubitCount;
+	std::vector<Complex> matrix(dimension * dimension);
+	for (unsigned long i = 0; i < dimension; i++) matrix[i * dimension + i] = 1;
+	return matrix;
+}
+
+/**
+ * Multiplies a matrix in place with the matrix of a gate acting on some of it's qubits,
+ * so that the result applies the original transformation, then the gate.
+ * Every row of the matrix is transformed like the states of an environment,
+ * which is much cheaper than multiplying with the expanded matrix of the gate.
+ *
+ * @param matrix The matrix (the rows one after the other)
+ * @param qubitCount The number of qubits the matrix acts on
+ * @param gate The matrix of the gate (the rows one after the other)
+ * @param positions The bits of the gate's qubits in the matrix indices
+ */
+static void apply(std::vector<Complex> &matrix, unsigned long qubitCount,
+                  const std::vector<Complex> &gate, const std::vector<unsigned long> &positions) {
+	unsigned long dimension = 1ul << qubitCount;
+	unsigned long gateDimension = 1ul << positions.size();
+
+	unsigned long mask = 0;
+	std::vector<unsigned long> offsets(gateDimension, 0);
+	for (unsigned long bit = 0; bit < positions.size(); bit++) {
+		mask |= 1ul << positions[bit];
+		for (unsigned long i = 0; i < gateDimension; i++) {
+			if ((i >> bit) & 1ul) offsets[i] |= 1ul << positions[bit];
+		}
+	}
+
+	std::vector<Complex> values(gateDimension);
+	for (unsigned long row = 0; row < dimension; row++) {
+		Complex *elements = matrix.data() + row * dimension;
+		for (unsigned long base = 0; base < dimension; base++) {
+			if (base & mask) continue;
+
+			for (unsigned long i = 0; i < gateDimension; i++) values[i] = elements[base + offsets[i]];
+			for (unsigned long j = 0; j < gateDimension; j++) {
+				Complex sum;
+				for (unsigned long i = 0; i < gateDimension; i++) sum = sum + values[i] * gate[i * gateDimension + j];
+				elements[base + offsets[j]] = sum;
+			}
+		}
+	}
+}
+
+/**
+ * Returns the positions of the given qubits in a block's qubits.
+ *
+ * @param qubits The ids of the qubits
+ * @param blockQubits The ids of the block's qubits
+ * @return The bits of the qubits in the block's matrix indices
+ */
+static std::vector<unsigned long> getPositions(const std::vector<unsigned long> &qubits,
+                                               const std::vector<unsigned long> &blockQubits) {
+	std::vector<unsigned long> positions;
+	for (unsigned long qubit : qubits) {
+		positions.push_back(std::find(blockQubits.begin(), blockQubits.end(), qubit) - blockQubits.begin());
+	}
+	return positions;
+}
+
+/**
+ * Checks whether the matrix only differs from the identity matrix by a global phase.
+ *
+ * @param matrix The matrix (the rows one after the other)
+ * @param qubitCount The number of qubits the matrix acts on
+ * @return True if it's an identity matrix
+ */
+static bool isIdentity(const std::vector<Complex> &matrix, unsigned long qubitCount) {
+	unsigned long dimension = 1ul << qubitCount;
+	for (unsigned long i = 0; i < dimension; i++) {
+		for (unsigned long j = 0; j < dimension; j++) {
+			Complex expected = i == j ? matrix[0] : Complex();
+			if ((matrix[i * dimension + j] - expected).length() > Matrix::EPSILON) return false;
+		}
+	}
+	return true;
+}
+
+
+
+std::vector<Instruction *> Optimizer::optimize(const std::vector<Instruction *> &instructions,
+                                               unsigned long qubitCount, unsigned long maxQubits) {
+	Optimizer optimizer(qubitCount, maxQubits);
+	optimizer.add(instructions);
+	optimizer.flushAll();
+	return optimizer.optimized;
+}
+
+Optimizer::Optimizer(unsigned long qubitCount, unsigned long maxQubits) :
+		maxQubits(maxQubits), blocks(qubitCount, nullptr) {
+
+}
+
+void Optimizer::add(const std::vector<Instruction *> &instructions) {
+	for (unsigned long i = 0; i < instructions.size(); i++) {
+		Instruction *instruction = instructions[i];
+		switch (instruction->getType()) {
+			case Instruction::UNITARY: {
+				U *u = (U *) instruction;
+				std::vector<Complex> matrix {
+						u->getMatrix()[0][0], u->getMatrix()[0][1],
+						u->getMatrix()[1][0], u->getMatrix()[1][1]
+				};
+				addGate(u, {u->getQubit()}, matrix);
+				break;
+			}
+			case Instruction::CONTROLLED_NOT: {
+				// The control qubit is the lower bit of the matrix indices
+				CX *cx = (CX *) instruction;
+				std::vector<Complex> matrix {
+						1, 0, 0, 0,
+						0, 0, 0, 1,
+						0, 0, 1, 0,
+						0, 1, 0, 0
+				};
+				addGate(cx, {cx->getQubit1(), cx->getQubit2()}, matrix);
+				break;
+			}
+			case Instruction::FUSED:
+				for (unsigned long qubit : ((Unitary *) instruction)->getQubits()) flush(qubit);
+				optimized.push_back(instruction);
+				break;
+			case Instruction::BARRIER:
+				flush(((Barrier *) instruction)->getQubit());
+				optimized.push_back(instruction);
+				break;
+			case Instruction::RESET:
+				flush(((Reset *) instruction)->getQubit());
+				optimized.push_back(instruction);
+				break;
+			case Instruction::MEASURE: {
+				// Consecutive measurements are kept together, so that they can be executed at once
+				unsigned long last = i;
+				while (last + 1 < instructions.size() && instructions[last + 1]->getType() == Instruction::MEASURE) last++;
+				for (unsigned long j = i; j <= last; j++) flush(((Measure *) instructions[j])->getQubit());
+				optimized.insert(optimized.end(), instructions.begin() + i, instructions.begin() + last + 1);
+				i = last;
+				break;
+			}
+			case Instruction::CHANNEL:
+				flush(((Channel *) instruction)->getQubit());
+				optimized.push_back(instruction);
+				break;
+			case Instruction::READOUT:
+				optimized.push_back(instruction);
+				break;
+			case Instruction::CONDITION:
+				// The guarded instructions are kept as they are, so that the jump stays valid
+				flushAll();
+				optimized.push_back(instruction);
+				for (unsigned long j = 0; j < ((Condition *) instruction)->getJump(); j++) {
+					optimized.push_back(instructions[++i]);
+				}
+				break;
+		}
+	}
+}
+
+void Optimizer::addGate(Instruction *gate, const std::vector<unsigned long> &qubits, const std::vector<Complex> &matrix) {
+	if (qubits.size() > maxQubits) {
+		for (unsigned long qubit : qubits) flush(qubit);
+		optimized.push_back(gate);
+		return;
+	}
+
+	// Collecting the blocks of the gate's qubits and the qubits the merged block would act on
+	std::vector<Block *> merged;
+	std::vector<unsigned long> mergedQubits;
+	for (unsigned long qubit : qubits) {
+		Block *block = blocks[qubit];
+		if (block == nullptr || std::find(merged.begin(), merged.end(), block) != merged.end()) continue;
+		merged.push_back(block);
+		mergedQubits.insert(mergedQubits.end(), block->qubits.begin(), block->qubits.end());
+	}
+	for (unsigned long qubit : qubits) {
+		if (std::find(mergedQubits.begin(), mergedQubits.end(), qubit) == mergedQubits.end()) mergedQubits.push_back(qubit);
+	}
+
+	if (mergedQubits.size() > maxQubits) {
+		for (unsigned long qubit : qubits) flush(qubit);
+		merged.clear();
+		mergedQubits = qubits;
+	}
+
+	Block *block;
+	if (merged.size() == 1 && merged[0]->qubits.size() == mergedQubits.size()) {
+		block = merged[0];
+	} else {
+		// The merged blocks act on different qubits, so they can be applied in any order
+		block = new Block();
+		block->qubits = mergedQubits;
+		block->matrix = identity(mergedQubits.size());
+		for (Block *single : merged) {
+			apply(block->matrix, block->qubits.size(), single->matrix, getPositions(single->qubits, block->qubits));
+			block->gates.insert(block->gates.end(), single->gates.begin(), single->gates.end());
+			delete single;
+		}
+		for (unsigned long qubit : block->qubits) blocks[qubit] = block;
+	}
+
+	apply(block->matrix, block->qubits.size(), matrix, getPositions(qubits, block->qubits));
+	block->gates.push_back(gate);
+}
+
+void Optimizer::flush(unsigned long qubit) {
+	Block *block = blocks[qubit];
+	if (block == nullptr) return;
+	for (unsigned long blockQubit : block->qubits) blocks[blockQubit] = nullptr;
+
+	if (block->gates.size() == 1) {
+		optimized.push_back(block->gates[0]);
+	} else {
+		for (Instruction *gate : block->gates) delete gate;
+
+		if (block->qubits.size() == 1) {
+			Complex matrix[2][2] {
+					{block->matrix[0], block->matrix[1]},
+					{block->matrix[2], block->matrix[3]}
+			};
+			U *u = new U(matrix, block->qubits[0]);
+			if (u->getShape() == Matrix::IDENTITY) {
+				delete u;
+			} else {
+				optimized.push_back(u);
+			}
+		} else if (!isIdentity(block->matrix, block->qubits.size())) {
+			optimized.push_back(new Unitary(block->qubits, block->matrix));
+		}
+	}
+
+	delete block;
+}
+
+void Optimizer::flushAll() {
+	for (unsigned long qubit = 0; qubit < blocks.size(); qubit++) flush(qubit);
+}
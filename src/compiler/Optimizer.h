@@ -0,0 +1,102 @@
+#ifndef QUANTUMSIMULATOR_OPTIMIZER_H
+#define QUANTUMSIMULATOR_OPTIMIZER_H
+
+
+#include <vector>
+#include "Instruction.h"
+#include "../math/Kernels.h"
+
+namespace compiler {
+
+	/**
+	 * Reduces the number of passes over the quantum states by fusing consecutive
+	 * gates. The gates are greedily clustered into blocks acting on at most a few qubits:
+	 * consecutive U gates on the same qubit are multiplied into one U gate,
+	 * and the larger blocks (including CX gates) are multiplied into one unitary gate.
+	 * Barriers, resets, measurements and noise channels stop the fusion on their qubits,
+	 * and conditions (with the instructions they guard) stop it on every qubit.
+	 */
+	class Optimizer {
+	public:
+
+		/**
+		 * The default for the largest number of qubits a fused gate can act on
+		 * (the most the environment can transform at once).
+		 */
+		static const unsigned long MAX_QUBITS = kernels::MAX_QUBITS;
+
+	private:
+
+		/**
+		 * A group of consecutive gates acting on a few qubits, and their combined
+		 * transformation matrix, where the i-th qubit is the i-th bit of the matrix indices.
+		 */
+		struct Block {
+			std::vector<unsigned long> qubits;
+			std::vector<Complex> matrix;
+			std::vector<Instruction *> gates;
+		};
+
+		unsigned long maxQubits;
+		std::vector<Block *> blocks;
+		std::vector<Instruction *> optimized;
+
+		/**
+		 * Creates an optimizer for a program with the given number of qubits.
+		 *
+		 * @param qubitCount The number of qubits
+		 * @param maxQubits The largest number of qubits a fused gate can act on
+		 */
+		Optimizer(unsigned long qubitCount, unsigned long maxQubits);
+
+		/**
+		 * Adds a gate to the block of it's qubits. If they aren't in the same block,
+		 * the blocks of the qubits are merged into a new one, or if that would act on
+		 * too many qubits, they are closed and the gate starts a new block.
+		 *
+		 * @param gate The gate
+		 * @param qubits The ids of the qubits the gate acts on
+		 * @param matrix The transformation of the gate, where the i-th qubit is the i-th bit of the matrix indices
+		 */
+		void addGate(Instruction *gate, const std::vector<unsigned long> &qubits, const std::vector<Complex> &matrix);
+
+		/**
+		 * Closes the block of the given qubit (if there is one) and
+		 * adds the fused instruction to the optimized instructions.
+		 *
+		 * @param qubit The id of the qubit
+		 */
+		void flush(unsigned long qubit);
+
+		/**
+		 * Closes every block.
+		 */
+		void flushAll();
+
+		/**
+		 * Adds the given instructions to the optimized instructions one by one.
+		 *
+		 * @param instructions The instructions
+		 */
+		void add(const std::vector<Instruction *> &instructions);
+
+	public:
+
+		/**
+		 * Fuses the given instructions. The instructions replaced by the fused
+		 * ones are deleted, the rest are moved to the returned vector.
+		 *
+		 * @param instructions The instructions
+		 * @param qubitCount The number of qubits used by the instructions
+		 * @param maxQubits The largest number of qubits a fused gate can act on
+		 * @return The optimized instructions
+		 */
+		static std::vector<Instruction *> optimize(const std::vector<Instruction *> &instructions,
+		                                           unsigned long qubitCount, unsigned long maxQubits = MAX_QUBITS);
+	};
+}
+
+using namespace compiler;
+
+
+#endif //QUANTUMSIMULATOR_OPTIMIZER_H
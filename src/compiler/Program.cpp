@@ -1,20 +1,123 @@
+#include <algorithm>
+#include <cmath>
 #include "Program.h"
 
+namespace {
+
+	/**
+	 * Returns the largest norm drift of the state's last shot.
+	 * Only the state vectors are checked, the other states are normalized by their operations.
+	 *
+	 * @return The norm drift
+	 */
+	template<typename State>
+	double measureNormDrift(const State &) {
+		return 0;
+	}
+
+	template<typename Scalar>
+	double measureNormDrift(const BasicEnvironment<Scalar> &env) {
+		return env.getNormDrift();
+	}
+}
+
 Program::Program(unsigned long bitCount, unsigned long qubitCount,
                  const std::map<std::string, std::vector<unsigned long>> &registerMap,
-                 const std::vector<Instruction *> &instructions) :
-		bitCount(bitCount), qubitCount(qubitCount), registerMap(registerMap), instructions(instructions) {
+                 const std::vector<Instruction *> &instructions, Backend backend) :
+		backend(backend), bitCount(bitCount), qubitCount(qubitCount), registerMap(registerMap),
+		instructions(instructions), bytecode(instructions, backend == STABILIZER ? Bytecode::STABILIZER :
+		                                                   backend == DENSITY_MATRIX ? Bytecode::DENSITY_MATRIX :
+		                                                   Bytecode::STATE_VECTOR),
+		results(std::max(1ul, (bitCount + 63) / 64)) {
 
-	programCounter = 0;
 	executionCount = 0;
+	shotPool = nullptr;
+	evaluated = false;
+	maxBondDimension = 64;
+	truncationThreshold = 1e-12;
+	singlePrecision = false;
+	normCheck = false;
+	normDrift = 0;
+	seed = ((unsigned long) std::random_device()() << 32ul) ^ std::random_device()();
 
-	results = new int[1 << bitCount];
-	std::fill(results, results + (1 << bitCount), 0);
+	sampleable = analyze(instructions, bitCount, qubitCount, backend, measures, readouts);
 }
 
 Program::~Program() {
 	for (Instruction *instruction : instructions) delete instruction;
-	delete[] results;
+	for (Environment *env : environments) delete env;
+	for (SingleEnvironment *env : singleEnvironments) delete env;
+	for (Tableau *tableau : tableaus) delete tableau;
+	for (MatrixProductState *state : states) delete state;
+	for (DensityMatrix *state : densityMatrices) delete state;
+	delete shotPool;
+}
+
+Program::Backend Program::getBackend() const {
+	return backend;
+}
+
+double Program::getStateSize() const {
+	switch (backend) {
+		case STABILIZER:
+			// The x and z words and the sign of the 2n + 1 rows
+			return (2.0 * qubitCount + 1) * (2.0 * sizeof(uint64_t) * ((qubitCount + 63) / 64) + 1);
+		case MATRIX_PRODUCT_STATE:
+			// Every qubit has two matrices of at most the largest bond dimension squared
+			return 2.0 * qubitCount * maxBondDimension * maxBondDimension * sizeof(Complex);
+		case DENSITY_MATRIX:
+			return std::ldexp((double) sizeof(Amplitude<double>), (int) (2 * qubitCount));
+		default:
+			return std::ldexp((double) (singlePrecision ? sizeof(Amplitude<float>) : sizeof(Amplitude<double>)),
+			                  (int) qubitCount);
+	}
+}
+
+void Program::setSeed(unsigned long seed) {
+	this->seed = seed;
+
+	// The environments' generators were seeded with the old seed
+	for (Environment *env : environments) delete env;
+	for (SingleEnvironment *env : singleEnvironments) delete env;
+	for (Tableau *tableau : tableaus) delete tableau;
+	for (MatrixProductState *state : states) delete state;
+	for (DensityMatrix *state : densityMatrices) delete state;
+	environments.clear();
+	singleEnvironments.clear();
+	tableaus.clear();
+	states.clear();
+	densityMatrices.clear();
+}
+
+void Program::setTruncation(unsigned long maxBondDimension, double truncationThreshold) {
+	this->maxBondDimension = maxBondDimension;
+	this->truncationThreshold = truncationThreshold;
+
+	for (MatrixProductState *state : states) delete state;
+	states.clear();
+}
+
+double Program::getTruncationError() const {
+	double error = 0;
+	for (MatrixProductState *state : states) error = std::max(error, state->getLargestTruncationError());
+	return error;
+}
+
+void Program::setSinglePrecision(bool singlePrecision) {
+	if (singlePrecision && backend != STATE_VECTOR) {
+		throw std::logic_error("Only a state vector can be simulated in single precision");
+	}
+	this->singlePrecision = singlePrecision;
+}
+
+void Program::setNormCheck(bool normCheck) {
+	this->normCheck = normCheck;
+	for (Environment *env : environments) env->setNormCheck(normCheck);
+	for (SingleEnvironment *env : singleEnvironments) env->setNormCheck(normCheck);
+}
+
+double Program::getNormDrift() const {
+	return normDrift;
 }
 
 void Program::print(bool qe) {
@@ -28,35 +131,393 @@ void Program::print(bool qe) {
 	}
 }
 
-void Program::execute() {
-	Environment env(bitCount, qubitCount);
-
-	for (programCounter = 0; programCounter < instructions.size(); programCounter++) {
-		programCounter += instructions[programCounter]->execute(env);
+void Program::reserveEnvironments(unsigned long count) {
+	if (backend == STABILIZER) {
+		while (tableaus.size() < count) tableaus.push_back(new Tableau(bitCount, qubitCount, seed));
+	} else if (backend == MATRIX_PRODUCT_STATE) {
+		while (states.size() < count) {
+			states.push_back(new MatrixProductState(bitCount, qubitCount, maxBondDimension, truncationThreshold, seed));
+		}
+	} else if (backend == DENSITY_MATRIX) {
+		while (densityMatrices.size() < count) densityMatrices.push_back(new DensityMatrix(bitCount, qubitCount, seed));
+	} else if (singlePrecision) {
+		while (singleEnvironments.size() < count) {
+			singleEnvironments.push_back(new SingleEnvironment(bitCount, qubitCount, seed));
+			singleEnvironments.back()->setNormCheck(normCheck);
+		}
+	} else {
+		while (environments.size() < count) {
+			environments.push_back(new Environment(bitCount, qubitCount, seed));
+			environments.back()->setNormCheck(normCheck);
+		}
 	}
+}
 
-	int index = 0;
+template<typename State>
+void Program::executeShot(State &env, unsigned long *outcome) const {
+	env.reset();
+	bytecode.execute(env);
+
+	std::fill(outcome, outcome + results.getWordCount(), 0ul);
 	for (unsigned long i = 0; i < bitCount; i++) {
-		index += env.getBit(i) << i;
+		outcome[i / 64] |= (unsigned long) env.getBit(i) << (i % 64);
+	}
+}
+
+void Program::execute() {
+	reserveEnvironments(1);
+	std::vector<unsigned long> outcome(results.getWordCount());
+	if (backend == STABILIZER) {
+		tableaus[0]->setStream(executionCount);
+		executeShot(*tableaus[0], outcome.data());
+	} else if (backend == MATRIX_PRODUCT_STATE) {
+		states[0]->setStream(executionCount);
+		executeShot(*states[0], outcome.data());
+	} else if (backend == DENSITY_MATRIX) {
+		densityMatrices[0]->setStream(executionCount);
+		executeShot(*densityMatrices[0], outcome.data());
+	} else if (singlePrecision) {
+		singleEnvironments[0]->setStream(executionCount);
+		executeShot(*singleEnvironments[0], outcome.data());
+		if (normCheck) normDrift = std::max(normDrift, measureNormDrift(*singleEnvironments[0]));
+	} else {
+		environments[0]->setStream(executionCount);
+		executeShot(*environments[0], outcome.data());
+		if (normCheck) normDrift = std::max(normDrift, measureNormDrift(*environments[0]));
 	}
-	results[index]++;
+	results.add(outcome.data());
 	executionCount++;
+	evaluated = false;
 }
 
-void Program::printResults() {
-	if (executionCount == 0) return;
+void Program::run(unsigned long shots, unsigned long threads) {
+	if (sampleable) {
+		sample(shots);
+		return;
+	}
+
+	if (backend == STATE_VECTOR && qubitCount >= Environment::getParallelThreshold()) threads = 1;
+	if (backend == DENSITY_MATRIX && 2 * qubitCount >= Environment::getParallelThreshold()) threads = 1;
+	threads = std::max(1ul, std::min(threads, shots));
+
+	reserveEnvironments(threads);
+	if (threads > 1 && (shotPool == nullptr || shotPool->getThreadCount() < threads)) {
+		delete shotPool;
+		shotPool = new ThreadPool(threads);
+	}
+	if (backend == STABILIZER) {
+		runShots(tableaus, shots, threads);
+	} else if (backend == MATRIX_PRODUCT_STATE) {
+		runShots(states, shots, threads);
+	} else if (backend == DENSITY_MATRIX) {
+		runShots(densityMatrices, shots, threads);
+	} else if (singlePrecision) {
+		runShots(singleEnvironments, shots, threads);
+	} else {
+		runShots(environments, shots, threads);
+	}
+}
 
-	for (unsigned long regState = 0; regState < 1ul << bitCount; regState++) {
-		if (results[regState] == 0) continue;
-		double chance = (double) results[regState] / executionCount;
-		for (std::pair<std::string, std::vector<unsigned long>> reg : registerMap) {
-			std::cout << reg.first << "[";
-			for (unsigned long i = 0; i < reg.second.size(); i++) {
-				unsigned long index = reg.second.size() - i - 1;
-				std::cout << ((regState >> reg.second[index]) & 1ul);
+template<typename State>
+void Program::runShots(const std::vector<State *> &envs, unsigned long shots, unsigned long threads) {
+	std::vector<Histogram> histograms(threads, Histogram(results.getWordCount()));
+	std::vector<double> drifts(threads, 0);
+	auto work = [&](unsigned long thread) {
+		// The pool may have more threads than this run needs
+		if (thread >= threads) return;
+		State &env = *envs[thread];
+		std::vector<unsigned long> outcome(results.getWordCount());
+		unsigned long begin = shots * thread / threads;
+		unsigned long end = shots * (thread + 1) / threads;
+		for (unsigned long shot = begin; shot < end; shot++) {
+			env.setStream(executionCount + shot);
+			executeShot(env, outcome.data());
+			histograms[thread].add(outcome.data());
+			if (normCheck) drifts[thread] = std::max(drifts[thread], measureNormDrift(env));
+		}
+	};
+
+	if (threads > 1) {
+		shotPool->each(work);
+	} else {
+		work(0);
+	}
+
+	for (const Histogram &histogram : histograms) results.merge(histogram);
+	for (double drift : drifts) normDrift = std::max(normDrift, drift);
+	executionCount += shots;
+	evaluated = false;
+}
+
+bool Program::analyze(const std::vector<Instruction *> &instructions, unsigned long bitCount, unsigned long qubitCount,
+                      Backend backend, std::vector<Measure *> &measures, std::vector<ReadoutError *> &readouts) {
+	std::vector<bool> measured(qubitCount, false);
+	// The sampled outcomes (and their probabilities) are indexed by 64 bit integers
+	bool sampleable = backend != STABILIZER && bitCount <= 64;
+	measures.clear();
+	readouts.clear();
+
+	for (unsigned long i = 0; i < instructions.size() && sampleable; i++) {
+		Instruction *instruction = instructions[i];
+		switch (instruction->getType()) {
+			case Instruction::UNITARY:
+				if (measured[((U *) instruction)->getQubit()]) sampleable = false;
+				break;
+			case Instruction::CONTROLLED_NOT:
+				if (measured[((CX *) instruction)->getQubit1()]) sampleable = false;
+				if (measured[((CX *) instruction)->getQubit2()]) sampleable = false;
+				break;
+			case Instruction::FUSED:
+				for (unsigned long qubit : ((Unitary *) instruction)->getQubits()) {
+					if (measured[qubit]) sampleable = false;
+				}
+				break;
+			case Instruction::CHANNEL:
+				// On a state vector the noise is drawn in every shot
+				if (backend == STATE_VECTOR || measured[((Channel *) instruction)->getQubit()]) sampleable = false;
+				break;
+			case Instruction::BARRIER:
+				break;
+			case Instruction::RESET:
+				// A state vector or a matrix product state is reset by measuring the qubit,
+				// which has to be drawn in every shot. Only a density matrix resets it deterministically.
+				if (backend != DENSITY_MATRIX || !measures.empty()) sampleable = false;
+				break;
+			case Instruction::MEASURE: {
+				// The readout errors of the bit's previous value are overwritten
+				Measure *measure = (Measure *) instruction;
+				measured[measure->getQubit()] = true;
+				measures.push_back(measure);
+				readouts.erase(std::remove_if(readouts.begin(), readouts.end(), [&](ReadoutError *readout) {
+					return readout->getBit() == measure->getBit();
+				}), readouts.end());
+				break;
 			}
-			std::cout << "] ";
+			case Instruction::READOUT:
+				readouts.push_back((ReadoutError *) instruction);
+				break;
+			case Instruction::CONDITION:
+				// Before the first measurement every bit is 0, so the condition is constant,
+				// but it mustn't guard a measurement, since those are not executed in order
+				if (!measures.empty()) sampleable = false;
+				for (unsigned long j = 1; j <= ((Condition *) instruction)->getJump() && i + j < instructions.size(); j++) {
+					if (instructions[i + j]->getType() == Instruction::MEASURE) sampleable = false;
+				}
+				break;
 		}
-		std::cout << ": " << chance << std::endl;
+	}
+
+	if (!sampleable) {
+		measures.clear();
+		readouts.clear();
+	}
+	return sampleable;
+}
+
+bool Program::isSampleable() const {
+	return sampleable;
+}
+
+bool Program::isSampleable(const std::vector<Instruction *> &instructions, unsigned long bitCount,
+                           unsigned long qubitCount, Backend backend) {
+	std::vector<Measure *> measures;
+	std::vector<ReadoutError *> readouts;
+	return analyze(instructions, bitCount, qubitCount, backend, measures, readouts);
+}
+
+template<typename State>
+void Program::addOutcomeChances(State &env, std::map<unsigned long, double> &chances) {
+	env.reset();
+	bytecode.execute(env, false);
+
+	for (unsigned long state = 0; state < env.getStateCount(); state++) {
+		double chance = env.getStateChance(state);
+		if (chance <= 0) continue;
+
+		unsigned long index = 0;
+		for (Measure *measure : measures) {
+			index &= ~(1ul << measure->getBit());
+			index |= ((state >> measure->getQubit()) & 1ul) << measure->getBit();
+		}
+		chances[index] += chance;
+	}
+}
+
+void Program::evaluate() {
+	if (!sampleable || (backend != STATE_VECTOR && backend != DENSITY_MATRIX)) {
+		throw std::logic_error("The program can't be evaluated");
+	}
+	reserveEnvironments(1);
+
+	std::map<unsigned long, double> chances;
+	if (backend == DENSITY_MATRIX) {
+		addOutcomeChances(*densityMatrices[0], chances);
+	} else if (singlePrecision) {
+		addOutcomeChances(*singleEnvironments[0], chances);
+	} else {
+		addOutcomeChances(*environments[0], chances);
+	}
+
+	if (normCheck) {
+		double total = 0;
+		for (const std::pair<const unsigned long, double> &chance : chances) total += chance.second;
+		normDrift = std::max(normDrift, std::abs(total - 1));
+	}
+
+	// Every readout error splits the chance of an outcome between it and the one with the bit flipped
+	for (ReadoutError *readout : readouts) {
+		std::map<unsigned long, double> misread;
+		unsigned long mask = 1ul << readout->getBit();
+		for (const std::pair<const unsigned long, double> &chance : chances) {
+			double flip = (chance.first & mask) ? readout->getFlip1() : readout->getFlip0();
+			misread[chance.first] += chance.second * (1 - flip);
+			misread[chance.first ^ mask] += chance.second * flip;
+		}
+		chances.swap(misread);
+	}
+
+	probabilities.clear();
+	for (const std::pair<const unsigned long, double> &chance : chances) {
+		if (chance.second > 0) probabilities.push_back(chance);
+	}
+	evaluated = true;
+}
+
+void Program::sample(unsigned long shots) {
+	if (!sampleable) throw std::logic_error("The program can't be sampled");
+	reserveEnvironments(1);
+
+	// The sampled shots are reported instead of the exact probabilities
+	evaluated = false;
+	if (backend == DENSITY_MATRIX) {
+		if (probabilities.empty()) {
+			evaluate();
+			evaluated = false;
+		}
+
+		std::vector<double> cumulative(probabilities.size());
+		double sum = 0;
+		for (unsigned long i = 0; i < probabilities.size(); i++) {
+			sum += probabilities[i].second;
+			cumulative[i] = sum;
+		}
+
+		DensityMatrix &state = *densityMatrices[0];
+		for (unsigned long shot = 0; shot < shots; shot++) {
+			state.setStream(executionCount);
+			double random = state.random() * sum;
+			std::vector<double>::iterator position = std::upper_bound(cumulative.begin(), cumulative.end(), random);
+			if (position == cumulative.end()) position--;
+			results.add(probabilities[position - cumulative.begin()].first);
+			executionCount++;
+		}
+		return;
+	}
+	if (backend == MATRIX_PRODUCT_STATE) {
+		MatrixProductState &state = *states[0];
+		state.reset();
+		bytecode.execute(state, false);
+
+		std::vector<unsigned int> values;
+		for (unsigned long shot = 0; shot < shots; shot++) {
+			state.setStream(executionCount);
+			state.sample(values);
+
+			unsigned long index = 0;
+			for (Measure *measure : measures) {
+				index &= ~(1ul << measure->getBit());
+				index |= (unsigned long) values[measure->getQubit()] << measure->getBit();
+			}
+			results.add(index);
+			executionCount++;
+		}
+		return;
+	}
+
+	if (singlePrecision) {
+		sampleEnvironment(*singleEnvironments[0], shots);
+	} else {
+		sampleEnvironment(*environments[0], shots);
+	}
+}
+
+template<typename Scalar>
+void Program::sampleEnvironment(BasicEnvironment<Scalar> &env, unsigned long shots) {
+	env.reset();
+
+	bytecode.execute(env, false);
+
+	double sum = 0;
+	for (unsigned long state = 0; state < env.getStateCount(); state++) sum += env.getStateChance(state);
+	if (normCheck) normDrift = std::max(normDrift, std::abs(sum - 1));
+
+	// Instead of storing the cumulative chances of the states (which would take as much memory
+	// as the state itself), the shots' random numbers are sorted, and they are matched with
+	// the states in a second pass, where the chances are summed in the same order
+	std::vector<std::pair<double, unsigned long>> targets(shots);
+	for (unsigned long shot = 0; shot < shots; shot++) {
+		env.setStream(executionCount + shot);
+		targets[shot] = std::make_pair(env.random() * sum, shot);
+	}
+	std::sort(targets.begin(), targets.end());
+
+	// Rounding errors may leave a target above the last state, which is then the last possible state
+	std::vector<unsigned long> drawn(shots);
+	unsigned long next = 0;
+	unsigned long last = 0;
+	double cumulative = 0;
+	for (unsigned long state = 0; state < env.getStateCount() && next < shots; state++) {
+		cumulative += env.getStateChance(state);
+		if (cumulative < sum) last = state + 1;
+		while (next < shots && targets[next].first < cumulative) drawn[targets[next++].second] = state;
+	}
+	for (; next < shots; next++) drawn[targets[next].second] = last;
+
+	for (unsigned long shot = 0; shot < shots; shot++) {
+		// The readout errors are drawn after the shot's first random number
+		if (!readouts.empty()) {
+			env.setStream(executionCount);
+			env.random();
+		}
+		unsigned long state = drawn[shot];
+
+		unsigned long index = 0;
+		for (Measure *measure : measures) {
+			index &= ~(1ul << measure->getBit());
+			index |= ((state >> measure->getQubit()) & 1ul) << measure->getBit();
+		}
+		for (ReadoutError *readout : readouts) {
+			unsigned long mask = 1ul << readout->getBit();
+			if (env.random() <= ((index & mask) ? readout->getFlip1() : readout->getFlip0())) index ^= mask;
+		}
+		results.add(index);
+		executionCount++;
+	}
+}
+
+void Program::printOutcome(const unsigned long *outcome, double chance) const {
+	for (const std::pair<const std::string, std::vector<unsigned long>> &reg : registerMap) {
+		std::cout << reg.first << "[";
+		for (unsigned long i = 0; i < reg.second.size(); i++) {
+			unsigned long bit = reg.second[reg.second.size() - i - 1];
+			std::cout << ((outcome[bit / 64] >> (bit % 64)) & 1ul);
+		}
+		std::cout << "] ";
+	}
+	std::cout << ": " << chance << std::endl;
+}
+
+void Program::printResults() {
+	if (evaluated) {
+		for (const std::pair<unsigned long, double> &probability : probabilities) {
+			printOutcome(&probability.first, probability.second);
+		}
+		return;
+	}
+
+	if (executionCount == 0) return;
+
+	for (const std::pair<std::vector<unsigned long>, unsigned long> &result : results.getOutcomes()) {
+		printOutcome(result.first.data(), (double) result.second / executionCount);
 	}
 }
@@ -5,6 +5,8 @@
 #include <vector>
 #include <map>
 #include "Instruction.h"
+#include "Bytecode.h"
+#include "Histogram.h"
 
 namespace compiler {
 
@@ -13,17 +15,144 @@ namespace compiler {
 	 * the results of their executions.
 	 */
 	class Program {
+	public:
+
+		/**
+		 * The possible ways of simulating the qubits: a state vector of 2^n amplitudes,
+		 * a stabilizer tableau (only for programs made of Clifford gates),
+		 * a matrix product state (only for programs without fused gates or noise)
+		 * or a density matrix of 4^n elements. On a state vector the noise is drawn in every shot,
+		 * while the density matrix describes it exactly.
+		 */
+		enum Backend {
+			STATE_VECTOR, STABILIZER, MATRIX_PRODUCT_STATE, DENSITY_MATRIX
+		};
+
 	private:
 
-		unsigned long programCounter;
+		Backend backend;
 		unsigned long executionCount;
+		unsigned long seed;
 
 		unsigned long bitCount;
 		unsigned long qubitCount;
 
 		std::map<std::string, std::vector<unsigned long>> registerMap;
 		std::vector<Instruction *> instructions;
-		int *results;
+		Bytecode bytecode;
+		Histogram results;
+
+		bool sampleable;
+		std::vector<Measure *> measures;
+		std::vector<ReadoutError *> readouts;
+		std::vector<std::pair<unsigned long, double>> probabilities;
+
+		/**
+		 * True if the exact probabilities were computed after the last executed shot,
+		 * so they are the results to print. Executing shots clears it, but the probabilities
+		 * are kept, since a density matrix is sampled from them.
+		 */
+		bool evaluated;
+
+		std::vector<Environment *> environments;
+		std::vector<SingleEnvironment *> singleEnvironments;
+		std::vector<Tableau *> tableaus;
+		std::vector<MatrixProductState *> states;
+		std::vector<DensityMatrix *> densityMatrices;
+
+		/**
+		 * The threads executing the shots of a run, kept between the runs (null if there was no multithreaded run).
+		 * It's separate from the environments' thread pool, which is only used by a single shot at a time.
+		 */
+		ThreadPool *shotPool;
+
+		unsigned long maxBondDimension;
+		double truncationThreshold;
+
+		bool singlePrecision;
+		bool normCheck;
+		double normDrift;
+
+		/**
+		 * Makes sure that there are at least the given number of environments (or single precision environments,
+		 * tableaus, matrix product states or density matrices, depending on the backend and the precision).
+		 * They are kept between the executions, and reset before every shot,
+		 * so their states don't have to be allocated again.
+		 *
+		 * @param count The number of needed environments
+		 */
+		void reserveEnvironments(unsigned long count);
+
+		/**
+		 * Checks whether every measurement is terminal, meaning no measured qubit
+		 * is manipulated afterwards and no reset or condition follows a measurement.
+		 * Only a density matrix can be reset before the measurements, the other states draw
+		 * the reset's outcome in every shot. If the program is sampleable, the measurements
+		 * (and the readout errors of their final values) are collected so that they can be sampled.
+		 * The sampled outcomes are 64 bit integers, so a program with more real bits is never sampled.
+		 *
+		 * @param instructions The instructions of the program
+		 * @param bitCount The number of real bits
+		 * @param qubitCount The number of quantum bits
+		 * @param backend The way of simulating the qubits
+		 * @param measures The terminal measurements (set by the function)
+		 * @param readouts The readout errors of the measured values (set by the function)
+		 * @return True if the program is sampleable
+		 */
+		static bool analyze(const std::vector<Instruction *> &instructions, unsigned long bitCount,
+		                    unsigned long qubitCount, Backend backend, std::vector<Measure *> &measures,
+		                    std::vector<ReadoutError *> &readouts);
+
+		/**
+		 * Executes the instructions except the measurements once in the given environment
+		 * (or density matrix) and adds the probabilities of it's basis states to the outcomes
+		 * they are measured as.
+		 *
+		 * @param env The environment (it's reset before the execution)
+		 * @param chances The probabilities of the outcomes
+		 */
+		template<typename State>
+		void addOutcomeChances(State &env, std::map<unsigned long, double> &chances);
+
+		/**
+		 * Prints an outcome grouped by the registers, and it's probability.
+		 *
+		 * @param outcome The values of the real bits (as the words of a histogram outcome)
+		 * @param chance The probability of the outcome
+		 */
+		void printOutcome(const unsigned long *outcome, double chance) const;
+
+		/**
+		 * Executes the instructions once in the given environment (or tableau).
+		 *
+		 * @param env The environment (it's reset before the execution)
+		 * @param outcome The resulting real bits as the words of a histogram outcome (set by the function)
+		 */
+		template<typename State>
+		void executeShot(State &env, unsigned long *outcome) const;
+
+		/**
+		 * Executes the given number of shots, split between the given number of threads of the shot pool,
+		 * each of them using the environment (or tableau) with it's id, and stores the results.
+		 * If the norm check is enabled, the norm drift of every shot is measured.
+		 *
+		 * @param envs The environments (at least one for each thread)
+		 * @param shots The number of executions
+		 * @param threads The number of threads
+		 */
+		template<typename State>
+		void runShots(const std::vector<State *> &envs, unsigned long shots, unsigned long threads);
+
+		/**
+		 * Executes the instructions except the measurements once in the given environment,
+		 * then draws the given number of measurement results from the final state's
+		 * probability distribution and stores them.
+		 *
+		 * @param env The environment (it's reset before the execution)
+		 * @param shots The number of results to draw
+		 */
+		template<typename Scalar>
+		void sampleEnvironment(BasicEnvironment<Scalar> &env, unsigned long shots);
 
 	public:
 
@@ -36,16 +165,88 @@ namespace compiler {
 		 * @param qubitCount The number of quantum bits
 		 * @param registerMap The bit to register map
 		 * @param instructions The instructions
+		 * @param backend The way of simulating the qubits
 		 */
 		Program(unsigned long bitCount, unsigned long qubitCount,
 		        const std::map<std::string, std::vector<unsigned long>> &registerMap,
-		        const std::vector<Instruction *> &instructions);
+		        const std::vector<Instruction *> &instructions, Backend backend = STATE_VECTOR);
 
 		/**
-		 * Deletes the instructions and the results.
+		 * Deletes the instructions, the environments and the shot pool.
 		 */
 		~Program();
 
+		/**
+		 * Returns the way the qubits are simulated.
+		 *
+		 * @return The backend
+		 */
+		Backend getBackend() const;
+
+		/**
+		 * Returns the memory taken by the state of a shot (every thread has it's own state).
+		 * For a matrix product state it's the upper bound given by the largest bond dimension.
+		 *
+		 * @return The size of a state in bytes
+		 */
+		double getStateSize() const;
+
+		/**
+		 * Sets the seed of the random number generators used by the executions.
+		 * Every execution draws it's random numbers from it's own stream
+		 * (numbered by the executions), so the results only depend on the seed,
+		 * not on the number of threads. By default, the seed is random.
+		 *
+		 * @param seed The seed
+		 */
+		void setSeed(unsigned long seed);
+
+		/**
+		 * Sets the limits of the matrix product states: the largest bond dimension
+		 * and the largest weight of the singular values dropped by a decomposition.
+		 * By default, the bonds are at most 64 wide and the threshold is 1e-12.
+		 *
+		 * @param maxBondDimension The largest bond dimension
+		 * @param truncationThreshold The truncation threshold
+		 */
+		void setTruncation(unsigned long maxBondDimension, double truncationThreshold);
+
+		/**
+		 * Returns the largest truncation error of the executed shots (the total weight of the
+		 * singular values dropped during a shot). It's always 0 for the other backends.
+		 *
+		 * @return The largest truncation error
+		 */
+		double getTruncationError() const;
+
+		/**
+		 * Sets whether the state vector stores it's coefficients in single precision.
+		 * It takes half the memory and bandwidth, but the results are only accurate
+		 * to about 1e-6, which is enough for sampling. By default, double precision is used.
+		 * Only valid for the state vector backend.
+		 *
+		 * @param singlePrecision Enables single precision
+		 */
+		void setSinglePrecision(bool singlePrecision);
+
+		/**
+		 * Sets whether the norm of the state vector is checked. Every collapse and normalization
+		 * compares the total probability with it's expected value before rescaling the state,
+		 * and the final state is checked with an extra pass after every execution, which shows
+		 * the rounding errors accumulated during the shot. By default, it's disabled.
+		 *
+		 * @param normCheck Enables the norm check
+		 */
+		void setNormCheck(bool normCheck);
+
+		/**
+		 * Returns the largest norm drift of the checked executions (the largest distance of the total
+		 * probability from it's expected value during a shot). It's 0 if the norm wasn't checked.
+		 *
+		 * @return The largest norm drift
+		 */
+		double getNormDrift() const;
+
 		/**
 		 * Prints the instructions one by one. If "qe" is true, then the instructions
 		 * are printed in an ibm quantum experience friendly way, so that it can be
@@ -62,7 +263,67 @@ namespace compiler {
 		void execute();
 
 		/**
-		 * Prints the interpreted execution results grouped by the registers.
+		 * Executes the instructions the given number of times and stores the results.
+		 * The executions are split between the given number of threads, each of them
+		 * using it's own environment and random number generator, and the results
+		 * of the threads are merged at the end. The threads are started by the first run
+		 * that needs them, and reused by the later ones. If the program is sampleable,
+		 * it's sampled instead, and if the environment is big enough to have
+		 * multithreaded state manipulations, only one thread is used.
+		 *
+		 * @param shots The number of executions
+		 * @param threads The number of threads
+		 */
+		void run(unsigned long shots, unsigned long threads);
+
+		/**
+		 * Returns true if every measurement is terminal, so the program
+		 * can be sampled instead of executed once per iteration.
+		 * Programs simulated by a stabilizer tableau, noisy programs simulated by a state vector,
+		 * programs with resets (unless they are simulated by a density matrix)
+		 * and programs with more than 64 real bits are never sampled.
+		 *
+		 * @return True if the program can be sampled
+		 */
+		bool isSampleable() const;
+
+		/**
+		 * Returns true if a program made of the given instructions could be sampled
+		 * when simulated by the given backend, without creating the program.
+		 *
+		 * @param instructions The instructions
+		 * @param bitCount The number of real bits
+		 * @param qubitCount The number of quantum bits
+		 * @param backend The way of simulating the qubits
+		 * @return True if the program would be sampleable
+		 */
+		static bool isSampleable(const std::vector<Instruction *> &instructions, unsigned long bitCount,
+		                         unsigned long qubitCount, Backend backend);
+
+		/**
+		 * Executes the instructions except the measurements only once, and computes
+		 * the exact probability of every outcome from the final state, including
+		 * the readout errors. They are printed instead of the sampled frequencies.
+		 * Only valid if the program is sampleable and simulated by a state vector or a density matrix.
+		 */
+		void evaluate();
+
+		/**
+		 * Executes the instructions except the measurements only once,
+		 * then draws the given number of measurement results from
+		 * the final state's probability distribution and stores them.
+		 * A matrix product state is sampled qubit by qubit, without listing it's amplitudes,
+		 * and a density matrix is sampled from it's evaluated outcome probabilities.
+		 * Only valid if the program is sampleable.
+		 *
+		 * @param shots The number of results to draw
+		 */
+		void sample(unsigned long shots);
+
+		/**
+		 * Prints the interpreted execution results grouped by the registers
+		 * (or the exact probabilities of the outcomes, if the program was evaluated
+		 * since the last executed shot).
 		 */
 		void printResults();
 	};
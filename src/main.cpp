@@ -1,17 +1,48 @@
 #include <iostream>
+#include <cmath>
+#include <thread>
 #include "tokenizer/Tokenizer.h"
 #include "ast/Builder.h"
 #include "compiler/Program.h"
 #include "compiler/Compiler.h"
+#include "compiler/NoiseModel.h"
 
 void printUsage(std::string program) {
-	std::cerr << "Usage: " << program << " <filename> <iterations>" << std::endl;
+	std::cerr << "Usage: " << program << " <filename> <iterations> [--threads <count>] [--seed <seed>]"
+	          << " [--mps [--bond-dimension <count>] [--truncation <threshold>]] [--noise <file> [--trajectories]]"
+	          << " [--precision <single|double>] [--check-norm] [--stabilizer <auto|always|never>]" << std::endl;
+}
+
+std::string formatSize(double bytes) {
+	const char *units[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB", "EiB"};
+	unsigned long unit = 0;
+	while (bytes >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+		bytes /= 1024;
+		unit++;
+	}
+	return std::to_string((unsigned long) std::ceil(bytes)) + " " + units[unit];
+}
+
+bool isNumber(const std::string &argument) {
+	if (argument.empty()) return false;
+	for (char c : argument) if (!isdigit(c)) return false;
+	return true;
 }
 
 int main(int argc, const char *argv[]) {
 	std::string programArgument = argv[0];
 	std::string fileArgument;
 	std::string iterationArgument;
+	std::string threadArgument = std::to_string(std::thread::hardware_concurrency());
+	std::string seedArgument;
+	std::string bondArgument;
+	std::string truncationArgument;
+	std::string noiseArgument;
+	std::string precisionArgument = "double";
+	std::string stabilizerArgument = "auto";
+	bool matrixProductState = false;
+	bool trajectories = false;
+	bool normCheck = false;
 
 #ifdef CPORTA
 
@@ -21,55 +52,178 @@ int main(int argc, const char *argv[]) {
 
 #else
 
+	// Separating the options from the positional arguments
+	std::vector<std::string> arguments;
+	for (int i = 1; i < argc; i++) {
+		std::string argument = argv[i];
+		if (argument == "--mps") {
+			matrixProductState = true;
+		} else if (argument == "--trajectories") {
+			trajectories = true;
+		} else if (argument == "--check-norm") {
+			normCheck = true;
+		} else if (argument == "--threads" || argument == "--seed" || argument == "--bond-dimension" ||
+		           argument == "--truncation" || argument == "--noise" || argument == "--precision" ||
+		           argument == "--stabilizer") {
+			if (i + 1 == argc) {
+				std::cerr << "Missing value for " << argument << std::endl;
+				printUsage(programArgument);
+				return 1;
+			}
+			if (argument == "--threads") threadArgument = argv[++i];
+			if (argument == "--seed") seedArgument = argv[++i];
+			if (argument == "--bond-dimension") bondArgument = argv[++i];
+			if (argument == "--truncation") truncationArgument = argv[++i];
+			if (argument == "--noise") noiseArgument = argv[++i];
+			if (argument == "--precision") precisionArgument = argv[++i];
+			if (argument == "--stabilizer") stabilizerArgument = argv[++i];
+		} else {
+			arguments.push_back(argument);
+		}
+	}
+
 	// Checking argument count
-	if (argc < 3 || argc > 3) {
-		if (argc < 3) std::cerr << "Too few argument" << std::endl;
-		if (argc > 3) std::cerr << "Too many arguments" << std::endl;
+	if (arguments.size() < 2 || arguments.size() > 2) {
+		if (arguments.size() < 2) std::cerr << "Too few argument" << std::endl;
+		if (arguments.size() > 2) std::cerr << "Too many arguments" << std::endl;
 		printUsage(programArgument);
 		return 1;
 	}
 
-	fileArgument = argv[1];
-	iterationArgument = argv[2];
+	fileArgument = arguments[0];
+	iterationArgument = arguments[1];
 
 #endif
 
 	// Checking argument validity
-	for (int i = 0; i < iterationArgument.size(); i++) if (!isdigit(iterationArgument[i])) {
+	if (!isNumber(iterationArgument)) {
 		std::cerr << "Invalid iteration count" << std::endl;
 		printUsage(programArgument);
 		return 1;
 	}
+	if (!isNumber(threadArgument)) {
+		std::cerr << "Invalid thread count" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	if (!seedArgument.empty() && !isNumber(seedArgument)) {
+		std::cerr << "Invalid seed" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	if (!bondArgument.empty() && (!isNumber(bondArgument) || std::stoul(bondArgument) == 0)) {
+		std::cerr << "Invalid bond dimension" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	if (trajectories && noiseArgument.empty()) {
+		std::cerr << "Trajectories need a noise model" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	if (precisionArgument != "single" && precisionArgument != "double") {
+		std::cerr << "Invalid precision" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	bool singlePrecision = precisionArgument == "single";
+	if (stabilizerArgument != "auto" && stabilizerArgument != "always" && stabilizerArgument != "never") {
+		std::cerr << "Invalid stabilizer mode" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	Compiler::StabilizerMode stabilizer = stabilizerArgument == "always" ? Compiler::ALWAYS :
+	                                      stabilizerArgument == "never" ? Compiler::NEVER : Compiler::AUTOMATIC;
+	if (singlePrecision && (matrixProductState || (!noiseArgument.empty() && !trajectories))) {
+		std::cerr << "Only a state vector can be simulated in single precision" << std::endl;
+		printUsage(programArgument);
+		return 1;
+	}
+	double truncation = 1e-12;
+	if (!truncationArgument.empty()) {
+		try {
+			truncation = std::stod(truncationArgument);
+		} catch (const std::logic_error &) {
+			truncation = -1;
+		}
+		if (!(truncation >= 0 && truncation < 1)) {
+			std::cerr << "Invalid truncation threshold" << std::endl;
+			printUsage(programArgument);
+			return 1;
+		}
+	}
 
 	// Getting arguments
 	std::string file = fileArgument;
 	unsigned long iterations = std::stoul(iterationArgument);
+	unsigned long threads = std::stoul(threadArgument);
+	Environment::setThreadCount(threads);
+
+	// Loading the noise model
+	NoiseModel noise;
+	if (!noiseArgument.empty()) noise = NoiseModel::load(noiseArgument);
 
 	// Tokenizing and building the AST
-	std::cout << "Tokenizing and building the Abstract Syntax Tree (this could take several seconds)..." << std::endl;
-	std::vector<Token> tokens = Tokenizer::tokenize(file);
-	ProgramAST *ast = Builder::build(tokens);
+	std::cout << "Tokenizing and building the Abstract Syntax Tree..." << std::endl;
+	ProgramAST *ast;
+	{
+		// The source and the tokens are only kept until the AST is built
+		Source source(file);
+		ast = Builder::build(Tokenizer::tokenize(source));
+	}
 
 	// Compiling
 	std::cout << "Compiling..." << std::endl;
-	Program *p = Compiler::compile(ast);
+	Program *p = Compiler::compile(ast, true, matrixProductState, noiseArgument.empty() ? nullptr : &noise, trajectories,
+	                               stabilizer);
 	delete ast;
+	if (!seedArgument.empty()) p->setSeed(std::stoul(seedArgument));
+	p->setTruncation(bondArgument.empty() ? 64 : std::stoul(bondArgument), truncation);
+	p->setNormCheck(normCheck);
+
+	// A Clifford program may be simulated by a tableau, so the precision doesn't matter
+	if (singlePrecision && p->getBackend() == Program::STATE_VECTOR) {
+		p->setSinglePrecision(true);
+		std::cout << "Using single precision" << std::endl;
+	}
 
 	// Executing
-	std::cout << "Executing..." << std::endl;
-	for (int i = 0; i < iterations; i++) {
-		p->execute();
-		double div = ((double) iterations) / 10;
-		if (i != 0 && (int) (i / div) != (int) ((i - 1) / div)) {
-			std::cout << (int) (i / div) << "0% ";
+	if (p->getBackend() == Program::MATRIX_PRODUCT_STATE) std::cout << "Using a matrix product state" << std::endl;
+	if (p->getBackend() == Program::DENSITY_MATRIX) std::cout << "Using a density matrix" << std::endl;
+	if (trajectories) std::cout << "Drawing the noise in every shot" << std::endl;
+	if (!noiseArgument.empty() && !trajectories && p->getBackend() == Program::STATE_VECTOR) {
+		std::cout << "Too many qubits for a density matrix (at most " << Compiler::MAX_DENSITY_MATRIX_QUBITS
+		          << "), drawing the noise in every shot" << std::endl;
+	}
+	std::cout << "Memory of a state: " << formatSize(p->getStateSize()) << std::endl;
+	if (p->getBackend() == Program::DENSITY_MATRIX && p->isSampleable()) {
+		std::cout << "Executing once and computing the exact probabilities..." << std::endl;
+		p->evaluate();
+	} else if (p->isSampleable()) {
+		std::cout << "Executing once and sampling the measurements..." << std::endl;
+		p->sample(iterations);
+	} else {
+		if (p->getBackend() == Program::STABILIZER) std::cout << "Every gate is a Clifford gate, using a stabilizer tableau" << std::endl;
+		std::cout << "Executing..." << std::endl;
+		unsigned long executed = 0;
+		for (int part = 1; part <= 10; part++) {
+			unsigned long target = iterations * part / 10;
+			p->run(target - executed, threads);
+			executed = target;
+			std::cout << part << "0%" << (part < 10 ? " " : "\n");
 			std::cout.flush();
 		}
 	}
-	std::cout << "100%" << std::endl;
 
 	// Printing results
 	std::cout << std::endl << "Results: " << std::endl;
 	p->printResults();
+	if (p->getBackend() == Program::MATRIX_PRODUCT_STATE) {
+		std::cout << std::endl << "Largest truncation error of a shot: " << p->getTruncationError() << std::endl;
+	}
+	if (normCheck && p->getBackend() == Program::STATE_VECTOR) {
+		std::cout << std::endl << "Largest norm drift of a shot: " << p->getNormDrift() << std::endl;
+	}
 
 	delete p;
 	return 0;
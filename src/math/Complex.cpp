@@ -24,6 +24,10 @@ double Complex::length() const {
 	return sqrt(lengthSquared());
 }
 
+double Complex::argument() const {
+	return atan2(i, r);
+}
+
 Complex Complex::operator+() const {
 	return *this;
 }
@@ -64,6 +64,13 @@ namespace math {
 		 */
 		double length() const;
 
+		/**
+		 * Return's the complex number's argument (it's angle from the positive real axis).
+		 *
+		 * @return The argument in the (-pi, pi] interval
+		 */
+		double argument() const;
+
 		/**
 		 * Returns the complex number itself.
 		 *
@@ -78,6 +85,17 @@ namespace math {
 		 */
 		Complex operator-() const;
 	};
+
+	/**
+	 * A complex number stored with the given precision (float or double),
+	 * used for the coefficients of the states. It's only a storage format:
+	 * the kernels compute with it's parts directly, everything else converts it to a Complex.
+	 */
+	template<typename Scalar>
+	struct Amplitude {
+		Scalar r;
+		Scalar i;
+	};
 }
 
 using namespace math;
@@ -0,0 +1,136 @@
+#include "DensityMatrix.h"
+#include "Kernels.h"
+
+namespace {
+
+	/**
+	 * The superoperator of the reset: the Kraus operators are |0><0| and |0><1|.
+	 */
+	const std::vector<Complex> RESET = DensityMatrix::getSuperoperator({1, 0, 0, 0, 0, 0, 1, 0});
+
+	Complex conjugate(const Complex &value) {
+		return Complex(value.r, -value.i);
+	}
+}
+
+std::vector<Complex> DensityMatrix::getSuperoperator(const std::vector<Complex> &operators) {
+	// rho'[r'][c'] = sum K[r'][r] * rho[r][c] * conj(K[c'][c]), and the
+	// operators are stored transposed, so the input index is the first one
+	std::vector<Complex> superoperator(16);
+	for (unsigned long k = 0; k + 4 <= operators.size(); k += 4) {
+		const Complex *kraus = &operators[k];
+		for (unsigned long input = 0; input < 4; input++) {
+			for (unsigned long output = 0; output < 4; output++) {
+				Complex row = kraus[(input & 1ul) * 2 + (output & 1ul)];
+				Complex column = kraus[(input >> 1ul) * 2 + (output >> 1ul)];
+				superoperator[input * 4 + output] = superoperator[input * 4 + output] + row * conjugate(column);
+			}
+		}
+	}
+	return superoperator;
+}
+
+DensityMatrix::DensityMatrix(unsigned long bitCount, unsigned long qubitCount, unsigned long seed) :
+		qubitCount(qubitCount), env(bitCount, 2 * qubitCount, seed) {
+
+}
+
+void DensityMatrix::reset() {
+	env.reset();
+}
+
+void DensityMatrix::setStream(unsigned long stream) {
+	env.setStream(stream);
+}
+
+double DensityMatrix::random() {
+	return env.random();
+}
+
+unsigned long DensityMatrix::getBitCount() const {
+	return env.getBitCount();
+}
+
+unsigned long DensityMatrix::getQubitCount() const {
+	return qubitCount;
+}
+
+unsigned long DensityMatrix::getStateCount() const {
+	return 1ul << qubitCount;
+}
+
+unsigned int DensityMatrix::getBit(unsigned long bit) const {
+	return env.getBit(bit);
+}
+
+void DensityMatrix::setBit(unsigned long bit, unsigned int value) {
+	env.setBit(bit, value);
+}
+
+double DensityMatrix::getStateChance(unsigned long state) const {
+	return env.getStateCoefficient(state + (state << qubitCount)).r;
+}
+
+double DensityMatrix::getQubitChance(unsigned long qubit) const {
+	double chance = 0;
+	for (unsigned long state = 0; state < getStateCount(); state++) {
+		if ((state >> qubit) & 1ul) chance += getStateChance(state);
+	}
+	return chance;
+}
+
+void DensityMatrix::applyTransform(unsigned long qubit, const Complex matrix[2][2]) {
+	Complex conjugated[2][2] = {
+			{conjugate(matrix[0][0]), conjugate(matrix[0][1])},
+			{conjugate(matrix[1][0]), conjugate(matrix[1][1])}
+	};
+	env.applyTransform(qubit, matrix);
+	env.applyTransform(qubit + qubitCount, conjugated);
+}
+
+void DensityMatrix::applyTransform(const unsigned long *qubits, unsigned long qubitCount, const Complex *matrix) {
+	unsigned long columns[kernels::MAX_QUBITS];
+	for (unsigned long i = 0; i < qubitCount; i++) columns[i] = qubits[i] + this->qubitCount;
+
+	unsigned long size = 1ul << (2 * qubitCount);
+	conjugateMatrix.resize(size);
+	for (unsigned long i = 0; i < size; i++) conjugateMatrix[i] = conjugate(matrix[i]);
+
+	env.applyTransform(qubits, qubitCount, matrix);
+	env.applyTransform(columns, qubitCount, conjugateMatrix.data());
+}
+
+void DensityMatrix::applyDiagonal(unsigned long qubit, const Complex &value0, const Complex &value1) {
+	env.applyDiagonal(qubit, value0, value1);
+	env.applyDiagonal(qubit + qubitCount, conjugate(value0), conjugate(value1));
+}
+
+void DensityMatrix::applyAntiDiagonal(unsigned long qubit, const Complex &value01, const Complex &value10) {
+	env.applyAntiDiagonal(qubit, value01, value10);
+	env.applyAntiDiagonal(qubit + qubitCount, conjugate(value01), conjugate(value10));
+}
+
+void DensityMatrix::applyNot(unsigned long qubit, unsigned long controls) {
+	env.applyNot(qubit, controls);
+	env.applyNot(qubit + qubitCount, controls << qubitCount);
+}
+
+void DensityMatrix::applyChannel(unsigned long qubit, const Complex *superoperator) {
+	unsigned long qubits[2] = {qubit, qubit + qubitCount};
+	env.applyTransform(qubits, 2, superoperator);
+}
+
+unsigned int DensityMatrix::measure(unsigned long qubit) {
+	double chance = getQubitChance(qubit);
+	unsigned int result = env.random() > chance ? 0 : 1;
+
+	// Collapsing both the row and the column scales the kept block by 1 / chance
+	double kept = result ? chance : 1 - chance;
+	env.collapse(qubit, result, kept);
+	env.collapse(qubit + qubitCount, result, kept);
+	return result;
+}
+
+void DensityMatrix::resetQubit(unsigned long qubit) {
+	applyChannel(qubit, RESET.data());
+}
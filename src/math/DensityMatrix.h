@@ -0,0 +1,202 @@
+#ifndef QUANTUMSIMULATOR_DENSITYMATRIX_H
+#define QUANTUMSIMULATOR_DENSITYMATRIX_H
+
+
+#include <vector>
+#include <random>
+#include "Complex.h"
+#include "Environment.h"
+
+namespace math {
+
+	/**
+	 * A mixed state of the qubits, stored as it's 2^n x 2^n density matrix rho.
+	 * Unlike a state vector, it can describe the effect of noise exactly,
+	 * without drawing the errors one shot at a time.
+	 *
+	 * The matrix is stored vectorised in an environment of 2n qubits: the element of row r
+	 * and column c is the coefficient of state r + (c << n). A gate U maps rho to U * rho * U^dagger,
+	 * so it's applied to the row qubits as U and to the column qubits as the conjugate of U,
+	 * and a noise channel is applied to a qubit's row and column at once, as a 4x4 superoperator.
+	 * This way every operation uses the environment's (possibly multithreaded) kernels,
+	 * but it takes 4^n amplitudes, so it's only feasible for a few qubits.
+	 */
+	class DensityMatrix {
+	private:
+
+		unsigned long qubitCount;
+		Environment env;
+		std::vector<Complex> conjugateMatrix;
+
+	public:
+
+		/**
+		 * Returns the superoperator of a channel given by it's Kraus operators K_i,
+		 * acting on a qubit's row (the lower bit of the indices) and column (the higher bit).
+		 *
+		 * @param operators The 2x2 Kraus operators (indexed by [input][output]) one after the other
+		 * @return The 4x4 superoperator (indexed by [input][output])
+		 */
+		static std::vector<Complex> getSuperoperator(const std::vector<Complex> &operators);
+
+		/**
+		 * Creates a density matrix with the given bit and qubit count, with every qubit in the 0 state.
+		 *
+		 * @param bitCount The number of real bits
+		 * @param qubitCount The number of quantum bits
+		 * @param seed The seed of the matrix's random number generator
+		 */
+		DensityMatrix(unsigned long bitCount, unsigned long qubitCount, unsigned long seed = std::random_device()());
+
+		DensityMatrix(const DensityMatrix &) = delete;
+		DensityMatrix &operator=(const DensityMatrix &) = delete;
+
+		/**
+		 * Sets every real bit to 0 and every qubit to the 0 state.
+		 */
+		void reset();
+
+		/**
+		 * Jumps to the beginning of the given stream of the matrix's random number generator.
+		 *
+		 * @param stream The id of the stream
+		 */
+		void setStream(unsigned long stream);
+
+		/**
+		 * Returns a uniformly distributed random number in the (0, 1] interval
+		 * from the matrix's own random number generator.
+		 *
+		 * @return The random number
+		 */
+		double random();
+
+		/**
+		 * Returns the number of real bits.
+		 *
+		 * @return The bit count
+		 */
+		unsigned long getBitCount() const;
+
+		/**
+		 * Returns the number of quantum bits.
+		 *
+		 * @return The qubit count
+		 */
+		unsigned long getQubitCount() const;
+
+		/**
+		 * Returns the number of basis states of the qubits.
+		 * (2 ^ qubit count)
+		 *
+		 * @return The number of states
+		 */
+		unsigned long getStateCount() const;
+
+		/**
+		 * Returns the value of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @return The value of a real bit
+		 */
+		unsigned int getBit(unsigned long bit) const;
+
+		/**
+		 * Set's the value of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @param value The value of the real bit
+		 */
+		void setBit(unsigned long bit, unsigned int value);
+
+		/**
+		 * Returns the probability of a basis state (it's diagonal element).
+		 *
+		 * @param state The id of the state
+		 * @return The state's probability
+		 */
+		double getStateChance(unsigned long state) const;
+
+		/**
+		 * Returns the probability of the given qubit being 1.
+		 *
+		 * @param qubit The id of the qubit
+		 * @return The probability of the qubit being 1
+		 */
+		double getQubitChance(unsigned long qubit) const;
+
+		/**
+		 * Applies a 2x2 matrix transformation to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param matrix The transformation (2x2 complex matrix)
+		 */
+		void applyTransform(unsigned long qubit, const Complex matrix[2][2]);
+
+		/**
+		 * Applies a 2^k x 2^k matrix transformation to k qubits.
+		 * The i-th qubit is the i-th bit of the matrix indices.
+		 *
+		 * @param qubits The ids of the qubits
+		 * @param qubitCount The number of qubits (at most kernels::MAX_QUBITS)
+		 * @param matrix The transformation (the rows of the complex matrix one after the other)
+		 */
+		void applyTransform(const unsigned long *qubits, unsigned long qubitCount, const Complex *matrix);
+
+		/**
+		 * Applies a diagonal 2x2 matrix transformation to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value0 The matrix element scaling the qubit's 0 state
+		 * @param value1 The matrix element scaling the qubit's 1 state
+		 */
+		void applyDiagonal(unsigned long qubit, const Complex &value0, const Complex &value1);
+
+		/**
+		 * Applies an anti-diagonal 2x2 matrix transformation to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value01 The matrix element mapping the qubit's 0 state to it's 1 state
+		 * @param value10 The matrix element mapping the qubit's 1 state to it's 0 state
+		 */
+		void applyAntiDiagonal(unsigned long qubit, const Complex &value01, const Complex &value10);
+
+		/**
+		 * Flips a qubit if all the control qubits are 1.
+		 *
+		 * @param qubit The id of the flipped qubit
+		 * @param controls The bit mask of the control qubits
+		 */
+		void applyNot(unsigned long qubit, unsigned long controls = 0);
+
+		/**
+		 * Applies a noise channel to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param superoperator The 4x4 superoperator of the channel (see getSuperoperator)
+		 */
+		void applyChannel(unsigned long qubit, const Complex *superoperator);
+
+		/**
+		 * Measures a qubit in the computational basis and collapses the state.
+		 * The result is drawn with the matrix's random number generator.
+		 *
+		 * @param qubit The id of the qubit
+		 * @return The measured value
+		 */
+		unsigned int measure(unsigned long qubit);
+
+		/**
+		 * Resets a qubit to the 0 state. Unlike on a state vector, it's done without a measurement,
+		 * by the channel moving the qubit's 1 state to it's 0 state.
+		 *
+		 * @param qubit The id of the qubit
+		 */
+		void resetQubit(unsigned long qubit);
+	};
+}
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_DENSITYMATRIX_H
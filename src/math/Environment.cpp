@@ -1,108 +1,387 @@
+#include <algorithm>
+#include <vector>
 #include "Environment.h"
+#include "Kernels.h"
+
+namespace {
+
+	template<typename Scalar>
+	inline double lengthSquared(const Amplitude<Scalar> &c) {
+		return (double) c.r * c.r + (double) c.i * c.i;
+	}
+
+	template<typename Scalar>
+	inline Amplitude<Scalar> toAmplitude(const Complex &c) {
+		return {(Scalar) c.r, (Scalar) c.i};
+	}
+
+	template<typename Scalar>
+	inline Amplitude<Scalar> operator*(const Amplitude<Scalar> &a, const Amplitude<Scalar> &b) {
+		return {a.r * b.r - a.i * b.i, a.r * b.i + a.i * b.r};
+	}
+
+	template<typename Scalar>
+	inline void rescale(Amplitude<Scalar> &c, Scalar factor) {
+		c.r *= factor;
+		c.i *= factor;
+	}
+}
+
+ThreadPool *EnvironmentBase::threadPool = nullptr;
+unsigned long EnvironmentBase::parallelThreshold = 14;
+
+EnvironmentBase::EnvironmentBase(unsigned long qubitCount) : qubitCount(qubitCount) {}
+
+void EnvironmentBase::setThreadCount(unsigned long threadCount) {
+	delete threadPool;
+	threadPool = threadCount > 1 ? new ThreadPool(threadCount) : nullptr;
+}
+
+void EnvironmentBase::setParallelThreshold(unsigned long qubitCount) {
+	parallelThreshold = qubitCount;
+}
+
+void EnvironmentBase::parallel(unsigned long count, const ThreadPool::Task &task) const {
+	if (threadPool != nullptr && qubitCount >= parallelThreshold) {
+		threadPool->run(count, task);
+	} else {
+		task(0, count);
+	}
+}
+
+double EnvironmentBase::parallelSum(unsigned long count, const ThreadPool::SumTask &task) const {
+	if (threadPool != nullptr && qubitCount >= parallelThreshold) {
+		return threadPool->sum(count, task);
+	} else {
+		return task(0, count);
+	}
+}
+
+template<typename Scalar>
+BasicEnvironment<Scalar>::BasicEnvironment(unsigned long bitCount, unsigned long qubitCount, unsigned long seed) :
+		EnvironmentBase(qubitCount), bitCount(bitCount), touchedQubits(0), norm(1), normCheck(false), normDrift(0),
+		generator(seed) {
 
-Environment::Environment(unsigned long bitCount, unsigned long qubitCount) : bitCount(bitCount), qubitCount(qubitCount) {
 	bitValues = new unsigned int[bitCount];
 	std::fill(bitValues, bitValues + bitCount, 0);
 
-	stateCoefficients = new Complex[1ul << qubitCount];
-	stateCoefficients[0] = 1;
+	stateCoefficients = new Amplitude<Scalar>[1ul << qubitCount]();
+	stateCoefficients[0].r = 1;
 }
 
-Environment::~Environment() {
+template<typename Scalar>
+BasicEnvironment<Scalar>::~BasicEnvironment() {
 	delete[] bitValues;
 	delete[] stateCoefficients;
 }
 
-unsigned long Environment::getBitCount() const {
+unsigned long EnvironmentBase::getParallelThreshold() {
+	return parallelThreshold;
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::reset() {
+	std::fill(bitValues, bitValues + bitCount, 0);
+
+	std::vector<unsigned long> untouched;
+	for (unsigned long bit = 0; bit < qubitCount; bit++) {
+		if (!((touchedQubits >> bit) & 1ul)) untouched.push_back(bit);
+	}
+
+	parallel(getStateCount() >> untouched.size(), [&](unsigned long begin, unsigned long end) {
+		if (untouched.empty()) {
+			std::fill(stateCoefficients + begin, stateCoefficients + end, Amplitude<Scalar>());
+			return;
+		}
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state = i;
+			for (unsigned long bit : untouched) state = kernels::insertZero(state, bit);
+			stateCoefficients[state] = Amplitude<Scalar>();
+		}
+	});
+	stateCoefficients[0].r = 1;
+	touchedQubits = 0;
+	norm = 1;
+	normDrift = 0;
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::setNormCheck(bool normCheck) {
+	this->normCheck = normCheck;
+}
+
+template<typename Scalar>
+double BasicEnvironment<Scalar>::getNormDrift() const {
+	return std::max(normDrift, std::abs(getTotalChance() - norm));
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::recordNormDrift(double total) {
+	if (normCheck) normDrift = std::max(normDrift, std::abs(total - norm));
+	norm = 1;
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::setStream(unsigned long stream) {
+	generator.setStream(stream);
+}
+
+template<typename Scalar>
+double BasicEnvironment<Scalar>::random() {
+	return generator.random();
+}
+
+template<typename Scalar>
+unsigned long BasicEnvironment<Scalar>::getBitCount() const {
 	return bitCount;
 }
 
-unsigned long Environment::getQubitCount() const {
+unsigned long EnvironmentBase::getQubitCount() const {
 	return qubitCount;
 }
 
-unsigned long Environment::getStateCount() const {
+unsigned long EnvironmentBase::getStateCount() const {
 	return 1ul << qubitCount;
 }
 
-unsigned int Environment::getBit(unsigned long bit) const {
+template<typename Scalar>
+unsigned int BasicEnvironment<Scalar>::getBit(unsigned long bit) const {
 	return bitValues[bit];
 }
 
-void Environment::setBit(unsigned long bit, unsigned int value) {
+template<typename Scalar>
+void BasicEnvironment<Scalar>::setBit(unsigned long bit, unsigned int value) {
 	if (value > 1) throw std::out_of_range("too big");
 	bitValues[bit] = value;
 }
 
-Complex Environment::getStateCoefficient(unsigned long state) const {
-	return stateCoefficients[state];
+template<typename Scalar>
+Complex BasicEnvironment<Scalar>::getStateCoefficient(unsigned long state) const {
+	return Complex(stateCoefficients[state].r, stateCoefficients[state].i);
 }
 
-double Environment::getStateChance(unsigned long state) const {
-	return stateCoefficients[state].lengthSquared();
+template<typename Scalar>
+double BasicEnvironment<Scalar>::getStateChance(unsigned long state) const {
+	return lengthSquared(stateCoefficients[state]);
 }
 
-double Environment::getQubitChance(unsigned long qubit) const {
-	double chance = 0;
+template<typename Scalar>
+double BasicEnvironment<Scalar>::getQubitChance(unsigned long qubit) const {
 	unsigned long pos = 1ul << qubit;
-	for (unsigned long state = 0; state < getStateCount() >> 1ul; state++) {
-		if (state & pos) chance += stateCoefficients[state].lengthSquared();
-	}
-	return chance;
+	return parallelSum(getStateCount() >> 1ul, [&](unsigned long begin, unsigned long end) {
+		double chance = 0;
+		for (unsigned long i = begin; i < end; i++) {
+			chance += lengthSquared(stateCoefficients[kernels::insertZero(i, qubit) + pos]);
+		}
+		return chance;
+	});
 }
 
-void Environment::applyTransform(unsigned long qubit, Complex matrix[2][2]) {
-	unsigned long state = 0;
+template<typename Scalar>
+void BasicEnvironment<Scalar>::applyTransform(unsigned long qubit, const Complex matrix[2][2]) {
+	touchedQubits |= 1ul << qubit;
+	parallel(getStateCount() >> 1ul, [&](unsigned long begin, unsigned long end) {
+		kernels::applyTransform(stateCoefficients, qubit, matrix, begin, end);
+	});
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::applyTransform(const unsigned long *qubits, unsigned long qubitCount, const Complex *matrix) {
+	if (qubitCount > kernels::MAX_QUBITS) throw std::out_of_range("too many qubits");
+	for (unsigned long i = 0; i < qubitCount; i++) touchedQubits |= 1ul << qubits[i];
+	parallel(getStateCount() >> qubitCount, [&](unsigned long begin, unsigned long end) {
+		kernels::applyTransform(stateCoefficients, qubits, qubitCount, matrix, begin, end);
+	});
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::applyDiagonal(unsigned long qubit, const Complex &value0, const Complex &value1) {
 	unsigned long pos = 1ul << qubit;
-	for (unsigned long i = 0; i < getStateCount() >> 1ul; i++, state++) {
-		if (state & pos) state += pos;
+	bool scale0 = value0.r != 1 || value0.i != 0;
+	Amplitude<Scalar> amplitude0 = toAmplitude<Scalar>(value0), amplitude1 = toAmplitude<Scalar>(value1);
+	parallel(getStateCount() >> 1ul, [&](unsigned long begin, unsigned long end) {
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state = kernels::insertZero(i, qubit);
+			if (scale0) stateCoefficients[state] = stateCoefficients[state] * amplitude0;
+			stateCoefficients[state + pos] = stateCoefficients[state + pos] * amplitude1;
+		}
+	});
+}
 
-		unsigned long state1 = state;
-		unsigned long state2 = state + pos;
+template<typename Scalar>
+void BasicEnvironment<Scalar>::applyAntiDiagonal(unsigned long qubit, const Complex &value01, const Complex &value10) {
+	unsigned long pos = 1ul << qubit;
+	touchedQubits |= pos;
+	Amplitude<Scalar> amplitude01 = toAmplitude<Scalar>(value01), amplitude10 = toAmplitude<Scalar>(value10);
+	parallel(getStateCount() >> 1ul, [&](unsigned long begin, unsigned long end) {
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state1 = kernels::insertZero(i, qubit);
+			unsigned long state2 = state1 + pos;
 
-		Complex coefficient1 = stateCoefficients[state1];
-		Complex coefficient2 = stateCoefficients[state2];
+			Amplitude<Scalar> coefficient1 = stateCoefficients[state1];
+			stateCoefficients[state1] = stateCoefficients[state2] * amplitude10;
+			stateCoefficients[state2] = coefficient1 * amplitude01;
+		}
+	});
+}
 
-		stateCoefficients[state1] = coefficient1 * matrix[0][0] + coefficient2 * matrix[1][0];
-		stateCoefficients[state2] = coefficient1 * matrix[0][1] + coefficient2 * matrix[1][1];
+template<typename Scalar>
+void BasicEnvironment<Scalar>::applyNot(unsigned long qubit, unsigned long controls) {
+	unsigned long pos = 1ul << qubit;
+	// If a control qubit is untouched, it's 0 in every state, so nothing is flipped
+	if ((controls & touchedQubits) == controls) touchedQubits |= pos;
+	std::vector<unsigned long> fixed;
+	for (unsigned long bit = 0; bit < qubitCount; bit++) {
+		if (bit == qubit || (controls >> bit) & 1ul) fixed.push_back(bit);
 	}
+
+	parallel(getStateCount() >> fixed.size(), [&](unsigned long begin, unsigned long end) {
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state = i;
+			for (unsigned long bit : fixed) state = kernels::insertZero(state, bit);
+			state |= controls;
+			std::swap(stateCoefficients[state], stateCoefficients[state + pos]);
+		}
+	});
+}
+
+template<typename Scalar>
+double BasicEnvironment<Scalar>::applyDamping(unsigned long qubit, double scale) {
+	unsigned long pos = 1ul << qubit;
+	double chance = parallelSum(getStateCount() >> 1ul, [&](unsigned long begin, unsigned long end) {
+		double chance = 0;
+		for (unsigned long i = begin; i < end; i++) {
+			Amplitude<Scalar> &coefficient = stateCoefficients[kernels::insertZero(i, qubit) + pos];
+			chance += lengthSquared(coefficient);
+			rescale(coefficient, (Scalar) scale);
+		}
+		return chance;
+	});
+	norm -= (1 - scale * scale) * chance;
+	return chance;
 }
 
-void Environment::applyTransform(unsigned long qubit1, unsigned long qubit2, Complex matrix[4][4]) {
-	unsigned long state = 0;
-	unsigned long pos1 = 1ul << qubit1;
-	unsigned long pos2 = 1ul << qubit2;
-	for (unsigned long i = 0; i < getStateCount() >> 2ul; i++, state++) {
-		if (qubit1 < qubit2) {
-			if (state & pos1) state += pos1;
-			if (state & pos2) state += pos2;
-		} else {
-			if (state & pos2) state += pos2;
-			if (state & pos1) state += pos1;
+template<typename Scalar>
+void BasicEnvironment<Scalar>::collapse(unsigned long qubit, unsigned int value, double chance) {
+	unsigned long pos = 1ul << qubit;
+	unsigned long kept = value ? pos : 0;
+	Scalar factor = (Scalar) (1.0 / sqrt(chance));
+	double total = parallelSum(getStateCount() >> 1ul, [&](unsigned long begin, unsigned long end) {
+		double total = 0;
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state = kernels::insertZero(i, qubit);
+			if (normCheck) total += lengthSquared(stateCoefficients[state]) + lengthSquared(stateCoefficients[state + pos]);
+			rescale(stateCoefficients[state + kept], factor);
+			stateCoefficients[state + (pos - kept)] = Amplitude<Scalar>();
 		}
+		return total;
+	});
+	recordNormDrift(total);
+}
+
+template<typename Scalar>
+unsigned long BasicEnvironment<Scalar>::measure(const unsigned long *qubits, unsigned long qubitCount) {
+	if (qubitCount == 1) {
+		double chance = getQubitChance(qubits[0]);
+		unsigned int result = random() > chance ? 0 : 1;
+		collapse(qubits[0], result, result ? chance : 1 - chance);
+		return result;
+	}
 
-		unsigned long state1 = state;
-		unsigned long state2 = state + pos1;
-		unsigned long state3 = state + pos2;
-		unsigned long state4 = state + pos1 + pos2;
+	// The chances are summed in chunks, so that the drawn state can be found
+	// by only scanning the chunk the random number falls into
+	unsigned long chunkSize = std::max(1ul, getStateCount() >> 10ul);
+	unsigned long chunkCount = getStateCount() / chunkSize;
+	std::vector<double> sums(chunkCount);
+	parallel(chunkCount, [&](unsigned long begin, unsigned long end) {
+		for (unsigned long chunk = begin; chunk < end; chunk++) {
+			double sum = 0;
+			for (unsigned long state = chunk * chunkSize; state < (chunk + 1) * chunkSize; state++) {
+				sum += lengthSquared(stateCoefficients[state]);
+			}
+			sums[chunk] = sum;
+		}
+	});
 
-		Complex coefficient1 = stateCoefficients[state1];
-		Complex coefficient2 = stateCoefficients[state2];
-		Complex coefficient3 = stateCoefficients[state3];
-		Complex coefficient4 = stateCoefficients[state4];
+	double total = 0;
+	for (double sum : sums) total += sum;
+	recordNormDrift(total);
+	double target = random() * total;
 
-		stateCoefficients[state1] = coefficient1 * matrix[0][0] + coefficient2 * matrix[1][0] + coefficient3 * matrix[2][0] + coefficient4 * matrix[3][0];
-		stateCoefficients[state2] = coefficient1 * matrix[0][1] + coefficient2 * matrix[1][1] + coefficient3 * matrix[2][1] + coefficient4 * matrix[3][1];
-		stateCoefficients[state3] = coefficient1 * matrix[0][2] + coefficient2 * matrix[1][2] + coefficient3 * matrix[2][2] + coefficient4 * matrix[3][2];
-		stateCoefficients[state4] = coefficient1 * matrix[0][3] + coefficient2 * matrix[1][3] + coefficient3 * matrix[2][3] + coefficient4 * matrix[3][3];
+	// Rounding errors may leave the target above the last state, which is then the last possible state
+	unsigned long drawn = 0;
+	double cumulative = 0;
+	for (unsigned long chunk = 0; chunk < chunkCount; chunk++) {
+		if (sums[chunk] == 0) continue;
+		if (cumulative + sums[chunk] < target && chunk + 1 < chunkCount) {
+			cumulative += sums[chunk];
+			continue;
+		}
+		for (unsigned long state = chunk * chunkSize; state < (chunk + 1) * chunkSize; state++) {
+			double chance = lengthSquared(stateCoefficients[state]);
+			if (chance == 0) continue;
+			drawn = state;
+			cumulative += chance;
+			if (cumulative >= target) break;
+		}
+		if (cumulative >= target) break;
 	}
-}
 
-void Environment::normalize() {
-	double sum = 0;
-	for (unsigned long state = 0; state < getStateCount(); state++) sum += getStateChance(state);
-	double scale = 1.0 / sqrt(sum);
-	for (unsigned long state = 0; state < getStateCount(); state++) {
-		stateCoefficients[state] = stateCoefficients[state] * scale;
+	unsigned long mask = 0;
+	unsigned long result = 0;
+	for (unsigned long i = 0; i < qubitCount; i++) {
+		mask |= 1ul << qubits[i];
+		result |= ((drawn >> qubits[i]) & 1ul) << i;
 	}
+	unsigned long pattern = drawn & mask;
+
+	double chance = parallelSum(getStateCount(), [&](unsigned long begin, unsigned long end) {
+		double chance = 0;
+		for (unsigned long state = begin; state < end; state++) {
+			if ((state & mask) == pattern) {
+				chance += lengthSquared(stateCoefficients[state]);
+			} else {
+				stateCoefficients[state] = Amplitude<Scalar>();
+			}
+		}
+		return chance;
+	});
+
+	// Only the states matching the measured values have to be scaled
+	std::vector<unsigned long> measured;
+	for (unsigned long bit = 0; bit < this->qubitCount; bit++) {
+		if ((mask >> bit) & 1ul) measured.push_back(bit);
+	}
+	Scalar factor = (Scalar) (1.0 / sqrt(chance));
+	parallel(getStateCount() >> measured.size(), [&](unsigned long begin, unsigned long end) {
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state = i;
+			for (unsigned long bit : measured) state = kernels::insertZero(state, bit);
+			state |= pattern;
+			rescale(stateCoefficients[state], factor);
+		}
+	});
+	return result;
 }
+
+template<typename Scalar>
+double BasicEnvironment<Scalar>::getTotalChance() const {
+	return parallelSum(getStateCount(), [&](unsigned long begin, unsigned long end) {
+		double sum = 0;
+		for (unsigned long state = begin; state < end; state++) sum += lengthSquared(stateCoefficients[state]);
+		return sum;
+	});
+}
+
+template<typename Scalar>
+void BasicEnvironment<Scalar>::normalize() {
+	double total = getTotalChance();
+	recordNormDrift(total);
+	Scalar factor = (Scalar) (1.0 / sqrt(total));
+	parallel(getStateCount(), [&](unsigned long begin, unsigned long end) {
+		for (unsigned long state = begin; state < end; state++) rescale(stateCoefficients[state], factor);
+	});
+}
+
+template class math::BasicEnvironment<double>;
+template class math::BasicEnvironment<float>;
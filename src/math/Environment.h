@@ -2,43 +2,80 @@
 #define QUANTUMSIMULATOR_ENVIRONMENT_H
 
 
+#include <random>
 #include "Complex.h"
+#include "ThreadPool.h"
+#include "Random.h"
 
 namespace math {
 
 	/**
-	 * The quantum environment controls the states in the environment.
+	 * The part of the quantum environments that doesn't depend on the precision of their states:
+	 * the thread pool shared by every environment, and the loops split between it's threads.
 	 */
-	class Environment {
+	class EnvironmentBase {
 	private:
 
-		unsigned long bitCount;
-		unsigned int *bitValues;
+		static ThreadPool *threadPool;
+		static unsigned long parallelThreshold;
+
+	protected:
 
 		unsigned long qubitCount;
-		Complex *stateCoefficients;
+
+		/**
+		 * Creates the base of an environment with the given qubit count.
+		 *
+		 * @param qubitCount The number of quantum bits in the environment
+		 */
+		explicit EnvironmentBase(unsigned long qubitCount);
+
+		/**
+		 * Executes the given task on the [0, count) loop. If the environment
+		 * is big enough, the loop is split between the threads of the thread pool.
+		 *
+		 * @param count The length of the loop
+		 * @param task The task executed on the parts of the loop
+		 */
+		void parallel(unsigned long count, const ThreadPool::Task &task) const;
+
+		/**
+		 * Executes the given task on the [0, count) loop and returns the sum of its results.
+		 * If the environment is big enough, the loop is split between the threads of the thread pool.
+		 *
+		 * @param count The length of the loop
+		 * @param task The task executed on the parts of the loop
+		 * @return The sum of the partial results
+		 */
+		double parallelSum(unsigned long count, const ThreadPool::SumTask &task) const;
 
 	public:
 
 		/**
-		 * Creates a new environment with the given bit and qubit count.
+		 * Sets the number of threads used by the state manipulating methods.
+		 * By default, only the calling thread is used. The pool is shared without locking,
+		 * so it has to be set before any environment is manipulated, and not while one is.
 		 *
-		 * @param bitCount The number of real bits in the environment
-		 * @param qubitCount The number of quantim bits in the environment
+		 * @param threadCount The number of threads (1 disables multithreading)
 		 */
-		Environment(unsigned long bitCount, unsigned long qubitCount);
+		static void setThreadCount(unsigned long threadCount);
 
 		/**
-		 * Deletes the real bits and quantum bits (their array).
+		 * Sets the smallest qubit count from which the state manipulating
+		 * methods are multithreaded. Smaller environments are manipulated serially,
+		 * because the synchronization would cost more than the work itself.
+		 *
+		 * @param qubitCount The smallest multithreaded qubit count
 		 */
-		~Environment();
+		static void setParallelThreshold(unsigned long qubitCount);
 
 		/**
-		 * Returns the number of real bits in the environment.
+		 * Returns the smallest qubit count from which the state manipulating
+		 * methods are multithreaded.
 		 *
-		 * @return The bit count
+		 * @return The smallest multithreaded qubit count
 		 */
-		unsigned long getBitCount() const;
+		static unsigned long getParallelThreshold();
 
 		/**
 		 * Returns the number of quantum bits in the environment.
@@ -54,6 +91,116 @@ namespace math {
 		 * @return The number of the environment's states
 		 */
 		unsigned long getStateCount() const;
+	};
+
+	/**
+	 * The quantum environment controls the states in the environment.
+	 * The coefficients of the states are stored with the given precision (float or double),
+	 * so a single precision environment takes half the memory and bandwidth,
+	 * at the cost of rounding errors that slowly change it's norm.
+	 * The probabilities are still summed in double precision.
+	 */
+	template<typename Scalar>
+	class BasicEnvironment : public EnvironmentBase {
+	private:
+
+		unsigned long bitCount;
+		unsigned int *bitValues;
+
+		Amplitude<Scalar> *stateCoefficients;
+
+		/**
+		 * The bit mask of the qubits that may be 1 in a state with a non-zero coefficient.
+		 * Every other qubit is still in it's initial state, so resetting only has to clear
+		 * the states made of these qubits.
+		 */
+		unsigned long touchedQubits;
+
+		/**
+		 * The expected sum of the probabilities: 1, unless the state was damped without
+		 * being normalized. The norm drift is the distance of the actual sum from it.
+		 */
+		double norm;
+		bool normCheck;
+		double normDrift;
+
+		Random generator;
+
+		/**
+		 * Records the norm drift of the state before it's rescaled to a sum of 1 (if the norm is checked).
+		 *
+		 * @param total The sum of the probabilities before the rescaling
+		 */
+		void recordNormDrift(double total);
+
+	public:
+
+		/**
+		 * Creates a new environment with the given bit and qubit count.
+		 *
+		 * @param bitCount The number of real bits in the environment
+		 * @param qubitCount The number of quantim bits in the environment
+		 * @param seed The seed of the environment's random number generator
+		 */
+		BasicEnvironment(unsigned long bitCount, unsigned long qubitCount, unsigned long seed = std::random_device()());
+
+		/**
+		 * Deletes the real bits and quantum bits (their array).
+		 */
+		~BasicEnvironment();
+
+		BasicEnvironment(const BasicEnvironment &) = delete;
+		BasicEnvironment &operator=(const BasicEnvironment &) = delete;
+
+		/**
+		 * Sets every real bit to 0 and every qubit to it's initial state,
+		 * so that the environment can be reused without reallocating it.
+		 * Only the coefficients of the states that could have become non-zero are cleared.
+		 */
+		void reset();
+
+		/**
+		 * Sets whether the norm drift is recorded. The collapses and normalizations then
+		 * compare the sum of the probabilities with it's expected value before rescaling the state,
+		 * so the rounding errors of the whole shot are seen, not only the ones since the last collapse.
+		 * By default, it's disabled.
+		 *
+		 * @param normCheck Enables the norm check
+		 */
+		void setNormCheck(bool normCheck);
+
+		/**
+		 * Returns the largest norm drift since the last reset: the distance of the sum of the probabilities
+		 * from it's expected value, before the recorded collapses and normalizations, and in the current state.
+		 * It takes a pass over the states.
+		 *
+		 * @return The largest norm drift
+		 */
+		double getNormDrift() const;
+
+		/**
+		 * Jumps to the beginning of the given stream of the environment's random number generator.
+		 * Using one stream for each shot makes the results independent of
+		 * how the shots are split between environments.
+		 *
+		 * @param stream The id of the stream
+		 */
+		void setStream(unsigned long stream);
+
+		/**
+		 * Returns a uniformly distributed random number in the (0, 1] interval
+		 * from the environment's own random number generator.
+		 *
+		 * @return The random number
+		 */
+		double random();
+
+		/**
+		 * Returns the number of real bits in the environment.
+		 *
+		 * @return The bit count
+		 */
+		unsigned long getBitCount() const;
 
 		/**
 		 * Returns the value of a real bit.
@@ -95,28 +242,114 @@ namespace math {
 		 */
 		double getQubitChance(unsigned long qubit) const;
 
+		/**
+		 * Returns the sum of the probabilities of every state, which is 1 for a normalized environment.
+		 * The distance from 1 shows how much the rounding errors changed the norm since the last normalization.
+		 *
+		 * @return The squared norm of the environment
+		 */
+		double getTotalChance() const;
+
 		/**
 		 * Applies a 2x2 matrix transformation to a qubit in the environment.
 		 *
 		 * @param qubit The id of the qubit
 		 * @param matrix The transformation (2x2 complex matrix)
 		 */
-		void applyTransform(unsigned long qubit, Complex matrix[2][2]);
+		void applyTransform(unsigned long qubit, const Complex matrix[2][2]);
 
 		/**
-		 * Applies a 4x4 matrix transformation to two qubits in the environment.
+		 * Applies a 2^k x 2^k matrix transformation to k qubits in the environment.
+		 * The i-th qubit is the i-th bit of the matrix indices.
 		 *
-		 * @param qubit1 The id of the first qubit
-		 * @param qubit2 The id of the second qubit
-		 * @param matrix The transformation (4x4 complex matrix)
+		 * @param qubits The ids of the qubits
+		 * @param qubitCount The number of qubits (at most kernels::MAX_QUBITS)
+		 * @param matrix The transformation (the rows of the complex matrix one after the other)
 		 */
-		void applyTransform(unsigned long qubit1, unsigned long qubit2, Complex matrix[4][4]);
+		void applyTransform(const unsigned long *qubits, unsigned long qubitCount, const Complex *matrix);
+
+		/**
+		 * Applies a diagonal 2x2 matrix transformation to a qubit in the environment,
+		 * by scaling the coefficients in place. If the first value is exactly 1,
+		 * only the states where the qubit is 1 are touched.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value0 The matrix element scaling the states where the qubit is 0
+		 * @param value1 The matrix element scaling the states where the qubit is 1
+		 */
+		void applyDiagonal(unsigned long qubit, const Complex &value0, const Complex &value1);
+
+		/**
+		 * Applies an anti-diagonal 2x2 matrix transformation to a qubit in the environment,
+		 * by swapping and scaling the coefficients of the state pairs.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value01 The matrix element mapping the qubit's 0 state to it's 1 state
+		 * @param value10 The matrix element mapping the qubit's 1 state to it's 0 state
+		 */
+		void applyAntiDiagonal(unsigned long qubit, const Complex &value01, const Complex &value10);
+
+		/**
+		 * Flips a qubit in every state where all the control qubits are 1,
+		 * by swapping the coefficients of the affected state pairs.
+		 * Without control qubits it's an X gate, with one a CX gate and with two a Toffoli gate.
+		 *
+		 * @param qubit The id of the flipped qubit
+		 * @param controls The bit mask of the control qubits
+		 */
+		void applyNot(unsigned long qubit, unsigned long controls = 0);
+
+		/**
+		 * Scales the coefficients of the states where the qubit is 1, without normalizing the environment.
+		 * It's the no-decay Kraus operator of amplitude damping, and since the probability
+		 * of the decay depends on the qubit's chance, that's computed in the same pass.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param scale The factor of the coefficients
+		 * @return The total probability of the states where the qubit is 1, before the scaling
+		 */
+		double applyDamping(unsigned long qubit, double scale);
+
+		/**
+		 * Collapses a qubit to the given value: the states where the qubit has the other value
+		 * are cleared, and the rest are scaled, so that the environment stays normalized.
+		 * Since the chance of the value is already known, it only takes one pass over the states.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value The value of the qubit after the collapse
+		 * @param chance The probability of the qubit having the given value before the collapse
+		 */
+		void collapse(unsigned long qubit, unsigned int value, double chance);
+
+		/**
+		 * Measures the given qubits together. A state is drawn according to the probabilities
+		 * (with the environment's random number generator), then the environment is collapsed
+		 * to the measured values of the qubits and normalized. No matter how many qubits are measured,
+		 * it takes two passes over the states (summing their chances, then zeroing the ones that don't
+		 * match the measured values) and a third one over the matching states, normalizing them.
+		 * A single qubit is measured by computing it's chance and collapsing it.
+		 *
+		 * @param qubits The ids of the qubits
+		 * @param qubitCount The number of qubits
+		 * @return The measured values (the i-th bit is the value of the i-th qubit)
+		 */
+		unsigned long measure(const unsigned long *qubits, unsigned long qubitCount);
 
 		/**
 		 * Normalizes the environment, so that the total sum of probabilities is 1.
 		 */
 		void normalize();
 	};
+
+	/**
+	 * The environment with double precision states.
+	 */
+	typedef BasicEnvironment<double> Environment;
+
+	/**
+	 * The environment with single precision states.
+	 */
+	typedef BasicEnvironment<float> SingleEnvironment;
 }
 
 using namespace math;
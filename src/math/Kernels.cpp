@@ -0,0 +1,372 @@
+#include <algorithm>
+#include "Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace math { namespace kernels {
+
+	template<typename Scalar>
+	using Transform = void (*)(Amplitude<Scalar> *, unsigned long, const Complex [2][2], unsigned long, unsigned long);
+
+	// The matrix is rounded to the precision of the states, and the products are summed
+	// in the same order as the Complex operators would sum them.
+
+	template<typename Scalar>
+	static void applyTransformScalar(Amplitude<Scalar> *states, unsigned long qubit, const Complex matrix[2][2],
+	                                 unsigned long begin, unsigned long end) {
+		unsigned long pos = 1ul << qubit;
+		Scalar m00r = (Scalar) matrix[0][0].r, m00i = (Scalar) matrix[0][0].i;
+		Scalar m01r = (Scalar) matrix[0][1].r, m01i = (Scalar) matrix[0][1].i;
+		Scalar m10r = (Scalar) matrix[1][0].r, m10i = (Scalar) matrix[1][0].i;
+		Scalar m11r = (Scalar) matrix[1][1].r, m11i = (Scalar) matrix[1][1].i;
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state1 = insertZero(i, qubit);
+			unsigned long state2 = state1 + pos;
+
+			Scalar r1 = states[state1].r, i1 = states[state1].i;
+			Scalar r2 = states[state2].r, i2 = states[state2].i;
+
+			states[state1].r = (r1 * m00r - i1 * m00i) + (r2 * m10r - i2 * m10i);
+			states[state1].i = (r1 * m00i + i1 * m00r) + (r2 * m10i + i2 * m10r);
+			states[state2].r = (r1 * m01r - i1 * m01i) + (r2 * m11r - i2 * m11i);
+			states[state2].i = (r1 * m01i + i1 * m01r) + (r2 * m11i + i2 * m11r);
+		}
+	}
+
+	template<typename Scalar>
+	using MultiTransform = void (*)(Amplitude<Scalar> *, const unsigned long *, const unsigned long *,
+	                                const Scalar *, const Scalar *, unsigned long, unsigned long);
+
+	// The matrix is split into real and imaginary parts, and every output coefficient is
+	// accumulated in it's own variable, so that the compiler can unroll and vectorize the loops
+	// (the dimension is a template parameter). The variants only differ in their target.
+
+	template<typename Scalar, unsigned long count>
+	__attribute__((always_inline))
+	inline void applyMultiTransformBody(Amplitude<Scalar> *states, const unsigned long *sorted, const unsigned long *offsets,
+	                                    const Scalar *real, const Scalar *imaginary,
+	                                    unsigned long begin, unsigned long end) {
+		const unsigned long dimension = 1ul << count;
+		for (unsigned long i = begin; i < end; i++) {
+			unsigned long state = i;
+			for (unsigned long bit = 0; bit < count; bit++) state = insertZero(state, sorted[bit]);
+
+			Scalar inputReal[dimension], inputImaginary[dimension];
+			for (unsigned long j = 0; j < dimension; j++) {
+				inputReal[j] = states[state + offsets[j]].r;
+				inputImaginary[j] = states[state + offsets[j]].i;
+			}
+
+			Scalar outputReal[dimension] = {}, outputImaginary[dimension] = {};
+			for (unsigned long j = 0; j < dimension; j++) {
+				for (unsigned long k = 0; k < dimension; k++) {
+					outputReal[k] += inputReal[j] * real[j * dimension + k] - inputImaginary[j] * imaginary[j * dimension + k];
+					outputImaginary[k] += inputReal[j] * imaginary[j * dimension + k] + inputImaginary[j] * real[j * dimension + k];
+				}
+			}
+
+			for (unsigned long j = 0; j < dimension; j++) {
+				states[state + offsets[j]].r = outputReal[j];
+				states[state + offsets[j]].i = outputImaginary[j];
+			}
+		}
+	}
+
+	template<typename Scalar, unsigned long count>
+	static void applyMultiTransformScalar(Amplitude<Scalar> *states, const unsigned long *sorted, const unsigned long *offsets,
+	                                      const Scalar *real, const Scalar *imaginary,
+	                                      unsigned long begin, unsigned long end) {
+		applyMultiTransformBody<Scalar, count>(states, sorted, offsets, real, imaginary, begin, end);
+	}
+
+#ifdef KERNELS_X86
+
+	// The coefficients are stored as (real, imaginary) pairs, so a vector holds 2 (AVX2) or 4 (AVX-512)
+	// neighbouring states, or twice as many in single precision. A complex multiply-add is done by multiplying the coefficients with the real
+	// parts of the matrix, and their swapped copies with the imaginary parts, then subtracting the
+	// two on the real lanes and adding them on the imaginary lanes.
+	// Neighbouring pairs only have neighbouring states if the qubit isn't one of the lowest ones,
+	// otherwise the scalar kernel is used.
+
+	__attribute__((target("avx2,fma")))
+	static void applyTransformAvx2(Amplitude<double> *states, unsigned long qubit, const Complex matrix[2][2],
+	                               unsigned long begin, unsigned long end) {
+		if (qubit < 1) return applyTransformScalar(states, qubit, matrix, begin, end);
+
+		unsigned long pos = 1ul << qubit;
+		double *data = (double *) states;
+
+		__m256d m00r = _mm256_set1_pd(matrix[0][0].r), m00i = _mm256_set1_pd(matrix[0][0].i);
+		__m256d m01r = _mm256_set1_pd(matrix[0][1].r), m01i = _mm256_set1_pd(matrix[0][1].i);
+		__m256d m10r = _mm256_set1_pd(matrix[1][0].r), m10i = _mm256_set1_pd(matrix[1][0].i);
+		__m256d m11r = _mm256_set1_pd(matrix[1][1].r), m11i = _mm256_set1_pd(matrix[1][1].i);
+
+		unsigned long i = begin;
+		unsigned long head = std::min(end, (begin + 1) & ~1ul);
+		applyTransformScalar(states, qubit, matrix, i, head);
+		for (i = head; i + 2 <= end; i += 2) {
+			double *p1 = data + 2 * insertZero(i, qubit);
+			double *p2 = p1 + 2 * pos;
+
+			__m256d c1 = _mm256_loadu_pd(p1);
+			__m256d c2 = _mm256_loadu_pd(p2);
+			__m256d s1 = _mm256_permute_pd(c1, 0x5);
+			__m256d s2 = _mm256_permute_pd(c2, 0x5);
+
+			__m256d r1 = _mm256_fmadd_pd(c2, m10r, _mm256_mul_pd(c1, m00r));
+			__m256d i1 = _mm256_fmadd_pd(s2, m10i, _mm256_mul_pd(s1, m00i));
+			__m256d r2 = _mm256_fmadd_pd(c2, m11r, _mm256_mul_pd(c1, m01r));
+			__m256d i2 = _mm256_fmadd_pd(s2, m11i, _mm256_mul_pd(s1, m01i));
+
+			_mm256_storeu_pd(p1, _mm256_addsub_pd(r1, i1));
+			_mm256_storeu_pd(p2, _mm256_addsub_pd(r2, i2));
+		}
+		applyTransformScalar(states, qubit, matrix, i, end);
+	}
+
+	__attribute__((target("avx512f")))
+	static void applyTransformAvx512(Amplitude<double> *states, unsigned long qubit, const Complex matrix[2][2],
+	                                 unsigned long begin, unsigned long end) {
+		if (qubit < 2) return applyTransformAvx2(states, qubit, matrix, begin, end);
+
+		unsigned long pos = 1ul << qubit;
+		double *data = (double *) states;
+
+		__m512d m00r = _mm512_set1_pd(matrix[0][0].r), m00i = _mm512_set1_pd(matrix[0][0].i);
+		__m512d m01r = _mm512_set1_pd(matrix[0][1].r), m01i = _mm512_set1_pd(matrix[0][1].i);
+		__m512d m10r = _mm512_set1_pd(matrix[1][0].r), m10i = _mm512_set1_pd(matrix[1][0].i);
+		__m512d m11r = _mm512_set1_pd(matrix[1][1].r), m11i = _mm512_set1_pd(matrix[1][1].i);
+		__m512d one = _mm512_set1_pd(1);
+
+		unsigned long i = begin;
+		unsigned long head = std::min(end, (begin + 3) & ~3ul);
+		applyTransformScalar(states, qubit, matrix, i, head);
+		for (i = head; i + 4 <= end; i += 4) {
+			double *p1 = data + 2 * insertZero(i, qubit);
+			double *p2 = p1 + 2 * pos;
+
+			__m512d c1 = _mm512_loadu_pd(p1);
+			__m512d c2 = _mm512_loadu_pd(p2);
+			__m512d s1 = _mm512_permute_pd(c1, 0x55);
+			__m512d s2 = _mm512_permute_pd(c2, 0x55);
+
+			__m512d r1 = _mm512_fmadd_pd(c2, m10r, _mm512_mul_pd(c1, m00r));
+			__m512d i1 = _mm512_fmadd_pd(s2, m10i, _mm512_mul_pd(s1, m00i));
+			__m512d r2 = _mm512_fmadd_pd(c2, m11r, _mm512_mul_pd(c1, m01r));
+			__m512d i2 = _mm512_fmadd_pd(s2, m11i, _mm512_mul_pd(s1, m01i));
+
+			_mm512_storeu_pd(p1, _mm512_fmaddsub_pd(r1, one, i1));
+			_mm512_storeu_pd(p2, _mm512_fmaddsub_pd(r2, one, i2));
+		}
+		applyTransformScalar(states, qubit, matrix, i, end);
+	}
+
+	__attribute__((target("avx2,fma")))
+	static void applyTransformAvx2(Amplitude<float> *states, unsigned long qubit, const Complex matrix[2][2],
+	                               unsigned long begin, unsigned long end) {
+		if (qubit < 2) return applyTransformScalar(states, qubit, matrix, begin, end);
+
+		unsigned long pos = 1ul << qubit;
+		float *data = (float *) states;
+
+		__m256 m00r = _mm256_set1_ps((float) matrix[0][0].r), m00i = _mm256_set1_ps((float) matrix[0][0].i);
+		__m256 m01r = _mm256_set1_ps((float) matrix[0][1].r), m01i = _mm256_set1_ps((float) matrix[0][1].i);
+		__m256 m10r = _mm256_set1_ps((float) matrix[1][0].r), m10i = _mm256_set1_ps((float) matrix[1][0].i);
+		__m256 m11r = _mm256_set1_ps((float) matrix[1][1].r), m11i = _mm256_set1_ps((float) matrix[1][1].i);
+
+		unsigned long i = begin;
+		unsigned long head = std::min(end, (begin + 3) & ~3ul);
+		applyTransformScalar(states, qubit, matrix, i, head);
+		for (i = head; i + 4 <= end; i += 4) {
+			float *p1 = data + 2 * insertZero(i, qubit);
+			float *p2 = p1 + 2 * pos;
+
+			__m256 c1 = _mm256_loadu_ps(p1);
+			__m256 c2 = _mm256_loadu_ps(p2);
+			__m256 s1 = _mm256_permute_ps(c1, 0xB1);
+			__m256 s2 = _mm256_permute_ps(c2, 0xB1);
+
+			__m256 r1 = _mm256_fmadd_ps(c2, m10r, _mm256_mul_ps(c1, m00r));
+			__m256 i1 = _mm256_fmadd_ps(s2, m10i, _mm256_mul_ps(s1, m00i));
+			__m256 r2 = _mm256_fmadd_ps(c2, m11r, _mm256_mul_ps(c1, m01r));
+			__m256 i2 = _mm256_fmadd_ps(s2, m11i, _mm256_mul_ps(s1, m01i));
+
+			_mm256_storeu_ps(p1, _mm256_addsub_ps(r1, i1));
+			_mm256_storeu_ps(p2, _mm256_addsub_ps(r2, i2));
+		}
+		applyTransformScalar(states, qubit, matrix, i, end);
+	}
+
+	__attribute__((target("avx512f")))
+	static void applyTransformAvx512(Amplitude<float> *states, unsigned long qubit, const Complex matrix[2][2],
+	                                 unsigned long begin, unsigned long end) {
+		if (qubit < 3) return applyTransformAvx2(states, qubit, matrix, begin, end);
+
+		unsigned long pos = 1ul << qubit;
+		float *data = (float *) states;
+
+		__m512 m00r = _mm512_set1_ps((float) matrix[0][0].r), m00i = _mm512_set1_ps((float) matrix[0][0].i);
+		__m512 m01r = _mm512_set1_ps((float) matrix[0][1].r), m01i = _mm512_set1_ps((float) matrix[0][1].i);
+		__m512 m10r = _mm512_set1_ps((float) matrix[1][0].r), m10i = _mm512_set1_ps((float) matrix[1][0].i);
+		__m512 m11r = _mm512_set1_ps((float) matrix[1][1].r), m11i = _mm512_set1_ps((float) matrix[1][1].i);
+		__m512 one = _mm512_set1_ps(1);
+
+		unsigned long i = begin;
+		unsigned long head = std::min(end, (begin + 7) & ~7ul);
+		applyTransformScalar(states, qubit, matrix, i, head);
+		for (i = head; i + 8 <= end; i += 8) {
+			float *p1 = data + 2 * insertZero(i, qubit);
+			float *p2 = p1 + 2 * pos;
+
+			__m512 c1 = _mm512_loadu_ps(p1);
+			__m512 c2 = _mm512_loadu_ps(p2);
+			__m512 s1 = _mm512_permute_ps(c1, 0xB1);
+			__m512 s2 = _mm512_permute_ps(c2, 0xB1);
+
+			__m512 r1 = _mm512_fmadd_ps(c2, m10r, _mm512_mul_ps(c1, m00r));
+			__m512 i1 = _mm512_fmadd_ps(s2, m10i, _mm512_mul_ps(s1, m00i));
+			__m512 r2 = _mm512_fmadd_ps(c2, m11r, _mm512_mul_ps(c1, m01r));
+			__m512 i2 = _mm512_fmadd_ps(s2, m11i, _mm512_mul_ps(s1, m01i));
+
+			_mm512_storeu_ps(p1, _mm512_fmaddsub_ps(r1, one, i1));
+			_mm512_storeu_ps(p2, _mm512_fmaddsub_ps(r2, one, i2));
+		}
+		applyTransformScalar(states, qubit, matrix, i, end);
+	}
+
+	template<typename Scalar, unsigned long count>
+	__attribute__((target("avx2,fma")))
+	static void applyMultiTransformAvx2(Amplitude<Scalar> *states, const unsigned long *sorted, const unsigned long *offsets,
+	                                    const Scalar *real, const Scalar *imaginary,
+	                                    unsigned long begin, unsigned long end) {
+		applyMultiTransformBody<Scalar, count>(states, sorted, offsets, real, imaginary, begin, end);
+	}
+
+	template<typename Scalar, unsigned long count>
+	__attribute__((target("avx512f")))
+	static void applyMultiTransformAvx512(Amplitude<Scalar> *states, const unsigned long *sorted, const unsigned long *offsets,
+	                                      const Scalar *real, const Scalar *imaginary,
+	                                      unsigned long begin, unsigned long end) {
+		applyMultiTransformBody<Scalar, count>(states, sorted, offsets, real, imaginary, begin, end);
+	}
+
+	static Level getSupportedLevel() {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f")) return AVX512;
+		if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return AVX2;
+		return SCALAR;
+	}
+
+#else
+
+	static Level getSupportedLevel() {
+		return SCALAR;
+	}
+
+#endif
+
+	template<typename Scalar>
+	static Transform<Scalar> selectTransform(Level level) {
+		switch (level) {
+#ifdef KERNELS_X86
+			case AVX512:
+				return applyTransformAvx512;
+			case AVX2:
+				return applyTransformAvx2;
+#endif
+			default:
+				return applyTransformScalar<Scalar>;
+		}
+	}
+
+	template<typename Scalar>
+	static MultiTransform<Scalar> selectMultiTransform(Level level, unsigned long count) {
+		static const MultiTransform<Scalar> scalar[MAX_QUBITS + 1] = {
+				nullptr, applyMultiTransformScalar<Scalar, 1>, applyMultiTransformScalar<Scalar, 2>,
+				applyMultiTransformScalar<Scalar, 3>, applyMultiTransformScalar<Scalar, 4>,
+				applyMultiTransformScalar<Scalar, 5>
+		};
+#ifdef KERNELS_X86
+		static const MultiTransform<Scalar> avx2[MAX_QUBITS + 1] = {
+				nullptr, applyMultiTransformAvx2<Scalar, 1>, applyMultiTransformAvx2<Scalar, 2>,
+				applyMultiTransformAvx2<Scalar, 3>, applyMultiTransformAvx2<Scalar, 4>,
+				applyMultiTransformAvx2<Scalar, 5>
+		};
+		static const MultiTransform<Scalar> avx512[MAX_QUBITS + 1] = {
+				nullptr, applyMultiTransformAvx512<Scalar, 1>, applyMultiTransformAvx512<Scalar, 2>,
+				applyMultiTransformAvx512<Scalar, 3>, applyMultiTransformAvx512<Scalar, 4>,
+				applyMultiTransformAvx512<Scalar, 5>
+		};
+		if (level == AVX512) return avx512[count];
+		if (level == AVX2) return avx2[count];
+#endif
+		return scalar[count];
+	}
+
+	static Level level = getSupportedLevel();
+	static Transform<double> transform = selectTransform<double>(level);
+	static Transform<float> singleTransform = selectTransform<float>(level);
+
+	Level getLevel() {
+		return level;
+	}
+
+	void setLevel(Level level) {
+		kernels::level = std::min(level, getSupportedLevel());
+		transform = selectTransform<double>(kernels::level);
+		singleTransform = selectTransform<float>(kernels::level);
+	}
+
+	// The matrix is split into it's real and imaginary parts in the precision of the states
+	template<typename Scalar>
+	static void applyMultiTransform(Amplitude<Scalar> *states, const unsigned long *qubits, unsigned long qubitCount,
+	                                const Complex *matrix, unsigned long begin, unsigned long end) {
+		unsigned long dimension = 1ul << qubitCount;
+
+		// An insertion sort is enough (and cheaper than std::sort) for at most MAX_QUBITS qubits
+		unsigned long sorted[MAX_QUBITS];
+		for (unsigned long i = 0; i < qubitCount; i++) {
+			unsigned long j = i;
+			for (; j > 0 && sorted[j - 1] > qubits[i]; j--) sorted[j] = sorted[j - 1];
+			sorted[j] = qubits[i];
+		}
+
+		unsigned long offsets[1ul << MAX_QUBITS] = {};
+		for (unsigned long j = 0; j < dimension; j++) {
+			for (unsigned long bit = 0; bit < qubitCount; bit++) {
+				if ((j >> bit) & 1ul) offsets[j] |= 1ul << qubits[bit];
+			}
+		}
+
+		Scalar real[1ul << (2 * MAX_QUBITS)], imaginary[1ul << (2 * MAX_QUBITS)];
+		for (unsigned long j = 0; j < dimension * dimension; j++) {
+			real[j] = (Scalar) matrix[j].r;
+			imaginary[j] = (Scalar) matrix[j].i;
+		}
+
+		selectMultiTransform<Scalar>(level, qubitCount)(states, sorted, offsets, real, imaginary, begin, end);
+	}
+
+	void applyTransform(Amplitude<double> *states, unsigned long qubit, const Complex matrix[2][2],
+	                    unsigned long begin, unsigned long end) {
+		transform(states, qubit, matrix, begin, end);
+	}
+
+	void applyTransform(Amplitude<float> *states, unsigned long qubit, const Complex matrix[2][2],
+	                    unsigned long begin, unsigned long end) {
+		singleTransform(states, qubit, matrix, begin, end);
+	}
+
+	void applyTransform(Amplitude<double> *states, const unsigned long *qubits, unsigned long qubitCount,
+	                    const Complex *matrix, unsigned long begin, unsigned long end) {
+		applyMultiTransform(states, qubits, qubitCount, matrix, begin, end);
+	}
+
+	void applyTransform(Amplitude<float> *states, const unsigned long *qubits, unsigned long qubitCount,
+	                    const Complex *matrix, unsigned long begin, unsigned long end) {
+		applyMultiTransform(states, qubits, qubitCount, matrix, begin, end);
+	}
+} }
@@ -0,0 +1,110 @@
+#ifndef QUANTUMSIMULATOR_KERNELS_H
+#define QUANTUMSIMULATOR_KERNELS_H
+
+
+#include "Complex.h"
+
+namespace math { namespace kernels {
+
+	/**
+	 * The instruction set extensions the kernels can be executed with.
+	 */
+	enum Level {
+		SCALAR, AVX2, AVX512
+	};
+
+	/**
+	 * Returns the instruction set extension used by the kernels.
+	 * By default it's the best one supported by the CPU.
+	 *
+	 * @return The used instruction set extension
+	 */
+	Level getLevel();
+
+	/**
+	 * Sets the instruction set extension used by the kernels.
+	 * If the CPU doesn't support it, the best supported one below it is used.
+	 *
+	 * @param level The requested instruction set extension
+	 */
+	void setLevel(Level level);
+
+	/**
+	 * The largest number of qubits a matrix transformation can be applied to at once.
+	 */
+	const unsigned long MAX_QUBITS = 5;
+
+	/**
+	 * Inserts a 0 bit into the given value at the given position.
+	 *
+	 * @param value The value
+	 * @param bit The position of the inserted bit
+	 * @return The value with the inserted bit
+	 */
+	inline unsigned long insertZero(unsigned long value, unsigned long bit) {
+		unsigned long mask = (1ul << bit) - 1;
+		return ((value & ~mask) << 1ul) | (value & mask);
+	}
+
+	/**
+	 * Applies a 2x2 matrix transformation to a qubit in the given states.
+	 * Only the [begin, end) pairs of states are transformed, where
+	 * the i-th pair is the i-th state whose qubit is 0 and its counterpart.
+	 *
+	 * @param states The state coefficients
+	 * @param qubit The id of the qubit
+	 * @param matrix The transformation (2x2 complex matrix)
+	 * @param begin The first pair to transform
+	 * @param end The pair after the last one to transform
+	 */
+	void applyTransform(Amplitude<double> *states, unsigned long qubit, const Complex matrix[2][2],
+	                    unsigned long begin, unsigned long end);
+
+	/**
+	 * Applies a 2x2 matrix transformation to a qubit in the given single precision states.
+	 * The matrix is rounded to single precision, and a vector holds twice as many states.
+	 *
+	 * @param states The state coefficients
+	 * @param qubit The id of the qubit
+	 * @param matrix The transformation (2x2 complex matrix)
+	 * @param begin The first pair to transform
+	 * @param end The pair after the last one to transform
+	 */
+	void applyTransform(Amplitude<float> *states, unsigned long qubit, const Complex matrix[2][2],
+	                    unsigned long begin, unsigned long end);
+
+	/**
+	 * Applies a 2^k x 2^k matrix transformation to k qubits in the given states,
+	 * where the i-th qubit is the i-th bit of the matrix indices.
+	 * Only the [begin, end) groups of states are transformed, where
+	 * the i-th group is the i-th state whose qubits are all 0 and it's 2^k - 1 counterparts.
+	 *
+	 * @param states The state coefficients
+	 * @param qubits The ids of the qubits (at most MAX_QUBITS of them)
+	 * @param qubitCount The number of qubits
+	 * @param matrix The transformation (the rows of the complex matrix one after the other)
+	 * @param begin The first group to transform
+	 * @param end The group after the last one to transform
+	 */
+	void applyTransform(Amplitude<double> *states, const unsigned long *qubits, unsigned long qubitCount,
+	                    const Complex *matrix, unsigned long begin, unsigned long end);
+
+	/**
+	 * Applies a 2^k x 2^k matrix transformation to k qubits in the given single precision states.
+	 * The matrix is rounded to single precision.
+	 *
+	 * @param states The state coefficients
+	 * @param qubits The ids of the qubits (at most MAX_QUBITS of them)
+	 * @param qubitCount The number of qubits
+	 * @param matrix The transformation (the rows of the complex matrix one after the other)
+	 * @param begin The first group to transform
+	 * @param end The group after the last one to transform
+	 */
+	void applyTransform(Amplitude<float> *states, const unsigned long *qubits, unsigned long qubitCount,
+	                    const Complex *matrix, unsigned long begin, unsigned long end);
+} }
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_KERNELS_H
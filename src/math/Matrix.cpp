@@ -0,0 +1,29 @@
+#include "Matrix.h"
+
+const double Matrix::EPSILON = 1e-12;
+
+static bool isZero(const Complex &c) {
+	return c.lengthSquared() < Matrix::EPSILON * Matrix::EPSILON;
+}
+
+Matrix::Shape Matrix::getShape(const Complex matrix[2][2]) {
+	if (isZero(matrix[0][1]) && isZero(matrix[1][0])) {
+		if (isZero(matrix[0][0] - matrix[1][1])) return IDENTITY;
+		return DIAGONAL;
+	}
+	if (isZero(matrix[0][0]) && isZero(matrix[1][1])) return ANTI_DIAGONAL;
+	return GENERAL;
+}
+
+void Matrix::removeGlobalPhase(Complex matrix[2][2]) {
+	int column = isZero(matrix[0][0]) ? 1 : 0;
+	Complex first = matrix[0][column];
+	if (isZero(first)) return;
+
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 2; j++) {
+			matrix[i][j] = matrix[i][j] / first;
+		}
+	}
+	matrix[0][column] = 1;
+}
@@ -0,0 +1,52 @@
+#ifndef QUANTUMSIMULATOR_MATRIX_H
+#define QUANTUMSIMULATOR_MATRIX_H
+
+
+#include "Complex.h"
+
+namespace math {
+
+	/**
+	 * Helper functions for the 2x2 transformation matrices of the single qubit gates.
+	 * The matrices are indexed the same way as in the environment: matrix[input][output].
+	 */
+	class Matrix {
+	public:
+
+		/**
+		 * The matrix shapes that have their own kernels in the environment.
+		 */
+		enum Shape {
+			IDENTITY, DIAGONAL, ANTI_DIAGONAL, GENERAL
+		};
+
+		/**
+		 * The largest absolute error tolerated when comparing matrix elements.
+		 */
+		static const double EPSILON;
+
+		/**
+		 * Returns the shape of the given matrix. Matrices that only differ from
+		 * the identity matrix by a global phase are considered to be identity matrices.
+		 *
+		 * @param matrix The matrix
+		 * @return The shape of the matrix
+		 */
+		static Shape getShape(const Complex matrix[2][2]);
+
+		/**
+		 * Divides the matrix by it's first non-zero element in the first row, so that
+		 * the element becomes exactly 1. For unitary matrices this only changes the global
+		 * phase, which has no measurable effect on the states, but it makes diagonal
+		 * and anti-diagonal matrices cheaper to apply.
+		 *
+		 * @param matrix The matrix
+		 */
+		static void removeGlobalPhase(Complex matrix[2][2]);
+	};
+}
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_MATRIX_H
@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "MatrixProductState.h"
+
+namespace {
+
+	/**
+	 * The singular values below this fraction of the norm are rounding errors, so they are always dropped.
+	 */
+	const double NOISE = 1e-28;
+
+	/**
+	 * Swaps the values of two qubits (the lower bit of the indices belongs to the first qubit).
+	 */
+	const Complex SWAP[4][4] = {{1, 0, 0, 0}, {0, 0, 1, 0}, {0, 1, 0, 0}, {0, 0, 0, 1}};
+
+	/**
+	 * The singular value decomposition of a matrix: M = U * diag(values) * V^dagger,
+	 * with the singular values in decreasing order. U is stored column by column,
+	 * and instead of V, the rows of diag(values) * V^dagger are stored one after the other.
+	 */
+	struct Decomposition {
+		std::vector<Complex> u;
+		std::vector<double> values;
+		std::vector<Complex> rest;
+	};
+
+	/**
+	 * Returns the complex conjugate of a complex number.
+	 *
+	 * @param c The complex number
+	 * @return The complex conjugate
+	 */
+	Complex conjugate(const Complex &c) {
+		return Complex(c.r, -c.i);
+	}
+
+	/**
+	 * Rotates two columns: b is multiplied by the given phase, then (a, b) is rotated by the given angle.
+	 *
+	 * @param a The first column
+	 * @param b The second column
+	 * @param size The length of the columns
+	 * @param c The cosine of the angle
+	 * @param s The sine of the angle
+	 * @param phase The phase of the second column
+	 */
+	void rotate(Complex *a, Complex *b, unsigned long size, double c, double s, const Complex &phase) {
+		for (unsigned long k = 0; k < size; k++) {
+			double yr = b[k].r * phase.r - b[k].i * phase.i;
+			double yi = b[k].r * phase.i + b[k].i * phase.r;
+			double xr = a[k].r, xi = a[k].i;
+			a[k].r = c * xr - s * yr;
+			a[k].i = c * xi - s * yi;
+			b[k].r = s * xr + c * yr;
+			b[k].i = s * xi + c * yi;
+		}
+	}
+
+	/**
+	 * Decomposes a matrix with one-sided Jacobi rotations: pairs of columns are rotated
+	 * until every column is orthogonal to the others, then the lengths of the columns are
+	 * the singular values. It's slower than the bidiagonalizing methods, but it's simple
+	 * and accurate, and the decomposed matrices are small. The rotations aren't accumulated,
+	 * diag(values) * V^dagger is computed as U^dagger * M at the end.
+	 *
+	 * @param matrix The matrix (column by column)
+	 * @param rows The number of rows
+	 * @param columns The number of columns
+	 * @return The decomposition with one singular value per column (the columns of U belonging to 0 are 0)
+	 */
+	Decomposition decompose(const std::vector<Complex> &matrix, unsigned long rows, unsigned long columns) {
+		std::vector<Complex> rotated = matrix;
+		std::vector<double> norms(columns);
+		double total = 0;
+
+		for (int sweep = 0; sweep < 64; sweep++) {
+			// The norms are updated by the rotations, and recomputed after every sweep so the errors don't add up
+			total = 0;
+			for (unsigned long i = 0; i < columns; i++) {
+				norms[i] = 0;
+				for (unsigned long k = 0; k < rows; k++) norms[i] += rotated[i * rows + k].lengthSquared();
+				total += norms[i];
+			}
+
+			bool changed = false;
+			for (unsigned long i = 0; i + 1 < columns; i++) {
+				if (norms[i] <= NOISE * total) continue;
+				for (unsigned long j = i + 1; j < columns; j++) {
+					if (norms[j] <= NOISE * total) continue;
+					Complex *a = &rotated[i * rows];
+					Complex *b = &rotated[j * rows];
+					double gammaR = 0, gammaI = 0;
+					for (unsigned long k = 0; k < rows; k++) {
+						gammaR += a[k].r * b[k].r + a[k].i * b[k].i;
+						gammaI += a[k].r * b[k].i - a[k].i * b[k].r;
+					}
+					double gamma = std::sqrt(gammaR * gammaR + gammaI * gammaI);
+					if (gamma <= 1e-15 * std::sqrt(norms[i] * norms[j])) continue;
+					changed = true;
+
+					// The phase makes the inner product real, then the angle zeroes it
+					double zeta = (norms[j] - norms[i]) / (2 * gamma);
+					double t = (zeta >= 0 ? 1 : -1) / (std::fabs(zeta) + std::sqrt(1 + zeta * zeta));
+					double c = 1 / std::sqrt(1 + t * t);
+					rotate(a, b, rows, c, c * t, Complex(gammaR / gamma, -gammaI / gamma));
+					norms[i] = std::max(0.0, norms[i] - t * gamma);
+					norms[j] += t * gamma;
+				}
+			}
+			if (!changed) break;
+		}
+
+		total = 0;
+		for (unsigned long i = 0; i < columns; i++) {
+			norms[i] = 0;
+			for (unsigned long k = 0; k < rows; k++) norms[i] += rotated[i * rows + k].lengthSquared();
+			total += norms[i];
+		}
+
+		std::vector<unsigned long> order(columns);
+		for (unsigned long i = 0; i < columns; i++) order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](unsigned long a, unsigned long b) {
+			return norms[a] > norms[b];
+		});
+
+		Decomposition decomposition;
+		decomposition.u.resize(rows * columns);
+		decomposition.values.resize(columns);
+		decomposition.rest.resize(columns * columns);
+		for (unsigned long i = 0; i < columns; i++) {
+			unsigned long column = order[i];
+			if (norms[column] <= NOISE * total) continue;
+
+			double length = std::sqrt(norms[column]);
+			decomposition.values[i] = length;
+			Complex *u = &decomposition.u[i * rows];
+			for (unsigned long k = 0; k < rows; k++) u[k] = rotated[column * rows + k] / length;
+
+			for (unsigned long j = 0; j < columns; j++) {
+				const Complex *m = &matrix[j * rows];
+				double sumR = 0, sumI = 0;
+				for (unsigned long k = 0; k < rows; k++) {
+					sumR += u[k].r * m[k].r + u[k].i * m[k].i;
+					sumI += u[k].r * m[k].i - u[k].i * m[k].r;
+				}
+				decomposition.rest[i * columns + j] = Complex(sumR, sumI);
+			}
+		}
+		return decomposition;
+	}
+
+	/**
+	 * Returns the number of singular values that aren't rounding errors.
+	 *
+	 * @param values The singular values in decreasing order
+	 * @return The number of kept values
+	 */
+	unsigned long getRank(const std::vector<double> &values) {
+		double total = 0;
+		for (double value : values) total += value * value;
+
+		unsigned long count = values.size();
+		while (count > 1 && values[count - 1] * values[count - 1] <= NOISE * total) count--;
+		return count;
+	}
+}
+
+MatrixProductState::MatrixProductState(unsigned long bitCount, unsigned long qubitCount, unsigned long maxBondDimension,
+                                       double truncationThreshold, unsigned long seed) :
+		bitCount(bitCount), qubitCount(qubitCount), maxBondDimension(std::max(1ul, maxBondDimension)),
+		truncationThreshold(truncationThreshold), largestTruncationError(0), generator(seed) {
+
+	bitValues = new unsigned int[bitCount];
+	reset();
+}
+
+MatrixProductState::~MatrixProductState() {
+	delete[] bitValues;
+}
+
+void MatrixProductState::reset() {
+	std::fill(bitValues, bitValues + bitCount, 0);
+
+	// Every tensor is the 1x2x1 tensor of the 0 state
+	std::vector<Complex> zero = {1, 0};
+	tensors.assign(qubitCount, zero);
+	bonds.assign(qubitCount + 1, 1);
+	center = 0;
+	truncationError = 0;
+}
+
+void MatrixProductState::setStream(unsigned long stream) {
+	generator.setStream(stream);
+}
+
+unsigned long MatrixProductState::getBitCount() const {
+	return bitCount;
+}
+
+unsigned long MatrixProductState::getQubitCount() const {
+	return qubitCount;
+}
+
+unsigned long MatrixProductState::getBondDimension() const {
+	return *std::max_element(bonds.begin(), bonds.end());
+}
+
+double MatrixProductState::getTruncationError() const {
+	return truncationError;
+}
+
+double MatrixProductState::getLargestTruncationError() const {
+	return largestTruncationError;
+}
+
+unsigned int MatrixProductState::getBit(unsigned long bit) const {
+	return bitValues[bit];
+}
+
+void MatrixProductState::setBit(unsigned long bit, unsigned int value) {
+	if (value > 1) throw std::out_of_range("too big");
+	bitValues[bit] = value;
+}
+
+void MatrixProductState::moveCenter(unsigned long qubit) {
+	// Moving right: the tensor is split as U * (S * V^dagger) and the second part is pushed to the next one
+	while (center < qubit) {
+		std::vector<Complex> &tensor = tensors[center];
+		std::vector<Complex> &next = tensors[center + 1];
+		unsigned long rows = 2 * bonds[center];
+		unsigned long right = bonds[center + 1];
+		unsigned long nextColumns = 2 * bonds[center + 2];
+
+		std::vector<Complex> matrix(rows * right);
+		for (unsigned long row = 0; row < rows; row++) {
+			for (unsigned long k = 0; k < right; k++) matrix[k * rows + row] = tensor[row * right + k];
+		}
+		Decomposition decomposition = decompose(matrix, rows, right);
+		unsigned long count = getRank(decomposition.values);
+
+		tensor.resize(rows * count);
+		for (unsigned long row = 0; row < rows; row++) {
+			for (unsigned long k = 0; k < count; k++) tensor[row * count + k] = decomposition.u[k * rows + row];
+		}
+
+		std::vector<Complex> result(count * nextColumns);
+		for (unsigned long k = 0; k < count; k++) {
+			for (unsigned long j = 0; j < right; j++) {
+				const Complex &factor = decomposition.rest[k * right + j];
+				for (unsigned long column = 0; column < nextColumns; column++) {
+					result[k * nextColumns + column] = result[k * nextColumns + column] + factor * next[j * nextColumns + column];
+				}
+			}
+		}
+		next = result;
+		bonds[center + 1] = count;
+		center++;
+	}
+
+	// Moving left: the adjoint of the tensor is decomposed, so it's split as (V * S) * U^dagger
+	while (center > qubit) {
+		std::vector<Complex> &tensor = tensors[center];
+		std::vector<Complex> &previous = tensors[center - 1];
+		unsigned long left = bonds[center];
+		unsigned long columns = 2 * bonds[center + 1];
+		unsigned long previousRows = 2 * bonds[center - 1];
+
+		// The rows of the tensor are the columns of it's adjoint
+		std::vector<Complex> matrix(left * columns);
+		for (unsigned long i = 0; i < left * columns; i++) matrix[i] = conjugate(tensor[i]);
+		Decomposition decomposition = decompose(matrix, columns, left);
+		unsigned long count = getRank(decomposition.values);
+
+		tensor.resize(count * columns);
+		for (unsigned long i = 0; i < count * columns; i++) tensor[i] = conjugate(decomposition.u[i]);
+
+		std::vector<Complex> result(previousRows * count);
+		for (unsigned long row = 0; row < previousRows; row++) {
+			for (unsigned long k = 0; k < count; k++) {
+				Complex sum;
+				for (unsigned long j = 0; j < left; j++) sum = sum + previous[row * left + j] * conjugate(decomposition.rest[k * left + j]);
+				result[row * count + k] = sum;
+			}
+		}
+		previous = result;
+		bonds[center] = count;
+		center--;
+	}
+}
+
+void MatrixProductState::applyAdjacent(unsigned long qubit, const Complex matrix[4][4]) {
+	moveCenter(qubit);
+	std::vector<Complex> &first = tensors[qubit];
+	std::vector<Complex> &second = tensors[qubit + 1];
+	unsigned long left = bonds[qubit];
+	unsigned long middle = bonds[qubit + 1];
+	unsigned long right = bonds[qubit + 2];
+	unsigned long rows = 2 * left;
+	unsigned long columns = 2 * right;
+
+	// Contracting the two tensors into a (left, first qubit) x (second qubit, right) matrix, column by column
+	std::vector<Complex> theta(rows * columns);
+	for (unsigned long row = 0; row < rows; row++) {
+		for (unsigned long k = 0; k < middle; k++) {
+			const Complex &a = first[row * middle + k];
+			if (a.r == 0 && a.i == 0) continue;
+			for (unsigned long column = 0; column < columns; column++) {
+				theta[column * rows + row] = theta[column * rows + row] + a * second[k * columns + column];
+			}
+		}
+	}
+
+	for (unsigned long l = 0; l < left; l++) {
+		for (unsigned long r = 0; r < right; r++) {
+			Complex *amplitudes[4] = {
+					&theta[r * rows + 2 * l], &theta[r * rows + 2 * l + 1],
+					&theta[(right + r) * rows + 2 * l], &theta[(right + r) * rows + 2 * l + 1]
+			};
+			Complex input[4] = {*amplitudes[0], *amplitudes[1], *amplitudes[2], *amplitudes[3]};
+			for (int output = 0; output < 4; output++) {
+				Complex sum;
+				for (int i = 0; i < 4; i++) sum = sum + input[i] * matrix[i][output];
+				*amplitudes[output] = sum;
+			}
+		}
+	}
+
+	Decomposition decomposition = decompose(theta, rows, columns);
+	const std::vector<double> &values = decomposition.values;
+	double total = 0;
+	for (double value : values) total += value * value;
+
+	// Dropping the rounding errors, the values above the cap, then the smallest values below the threshold
+	unsigned long count = std::min(getRank(values), maxBondDimension);
+	double dropped = 0;
+	for (unsigned long k = count; k < values.size(); k++) dropped += values[k] * values[k];
+	while (count > 1 && dropped + values[count - 1] * values[count - 1] <= truncationThreshold * total) {
+		count--;
+		dropped += values[count] * values[count];
+	}
+	truncationError += dropped / total;
+	largestTruncationError = std::max(largestTruncationError, truncationError);
+
+	first.resize(rows * count);
+	for (unsigned long row = 0; row < rows; row++) {
+		for (unsigned long k = 0; k < count; k++) first[row * count + k] = decomposition.u[k * rows + row];
+	}
+
+	// The kept part is normalized, so the errors don't shrink the later probabilities
+	double scale = 1 / std::sqrt(total - dropped);
+	second.resize(count * columns);
+	for (unsigned long k = 0; k < count; k++) {
+		for (unsigned long column = 0; column < columns; column++) {
+			second[k * columns + column] = decomposition.rest[k * columns + column] * scale;
+		}
+	}
+	bonds[qubit + 1] = count;
+	center = qubit + 1;
+}
+
+void MatrixProductState::applyGate(unsigned long qubit1, unsigned long qubit2, const Complex matrix[4][4]) {
+	if (qubit1 == qubit2) throw std::invalid_argument("the qubits of a two qubit gate must be different");
+	unsigned long low = std::min(qubit1, qubit2);
+	unsigned long high = std::max(qubit1, qubit2);
+
+	// The higher qubit is swapped next to the lower one
+	for (unsigned long site = high; site > low + 1; site--) applyAdjacent(site - 1, SWAP);
+
+	if (qubit1 < qubit2) {
+		applyAdjacent(low, matrix);
+	} else {
+		// The bits of the indices are swapped, so the lower qubit is the lower bit
+		Complex swapped[4][4];
+		for (int input = 0; input < 4; input++) {
+			for (int output = 0; output < 4; output++) {
+				swapped[(input >> 1) | ((input & 1) << 1)][(output >> 1) | ((output & 1) << 1)] = matrix[input][output];
+			}
+		}
+		applyAdjacent(low, swapped);
+	}
+
+	for (unsigned long site = low + 2; site <= high; site++) applyAdjacent(site - 1, SWAP);
+}
+
+void MatrixProductState::applyTransform(unsigned long qubit, const Complex matrix[2][2]) {
+	std::vector<Complex> &tensor = tensors[qubit];
+	unsigned long left = bonds[qubit];
+	unsigned long right = bonds[qubit + 1];
+	for (unsigned long l = 0; l < left; l++) {
+		for (unsigned long r = 0; r < right; r++) {
+			Complex &amplitude0 = tensor[(2 * l) * right + r];
+			Complex &amplitude1 = tensor[(2 * l + 1) * right + r];
+			Complex coefficient0 = amplitude0, coefficient1 = amplitude1;
+			amplitude0 = coefficient0 * matrix[0][0] + coefficient1 * matrix[1][0];
+			amplitude1 = coefficient0 * matrix[0][1] + coefficient1 * matrix[1][1];
+		}
+	}
+}
+
+void MatrixProductState::applyDiagonal(unsigned long qubit, const Complex &value0, const Complex &value1) {
+	std::vector<Complex> &tensor = tensors[qubit];
+	unsigned long left = bonds[qubit];
+	unsigned long right = bonds[qubit + 1];
+	for (unsigned long l = 0; l < left; l++) {
+		for (unsigned long r = 0; r < right; r++) {
+			tensor[(2 * l) * right + r] = tensor[(2 * l) * right + r] * value0;
+			tensor[(2 * l + 1) * right + r] = tensor[(2 * l + 1) * right + r] * value1;
+		}
+	}
+}
+
+void MatrixProductState::applyAntiDiagonal(unsigned long qubit, const Complex &value01, const Complex &value10) {
+	std::vector<Complex> &tensor = tensors[qubit];
+	unsigned long left = bonds[qubit];
+	unsigned long right = bonds[qubit + 1];
+	for (unsigned long l = 0; l < left; l++) {
+		for (unsigned long r = 0; r < right; r++) {
+			Complex &amplitude0 = tensor[(2 * l) * right + r];
+			Complex &amplitude1 = tensor[(2 * l + 1) * right + r];
+			Complex coefficient0 = amplitude0;
+			amplitude0 = amplitude1 * value10;
+			amplitude1 = coefficient0 * value01;
+		}
+	}
+}
+
+void MatrixProductState::applyNot(unsigned long qubit, unsigned long control) {
+	// The control qubit is the lower bit of the matrix indices
+	const Complex matrix[4][4] = {{1, 0, 0, 0}, {0, 0, 0, 1}, {0, 0, 1, 0}, {0, 1, 0, 0}};
+	applyGate(control, qubit, matrix);
+}
+
+unsigned int MatrixProductState::measure(unsigned long qubit) {
+	// With the center on the qubit, the rest of the tensors don't change the probabilities
+	moveCenter(qubit);
+	std::vector<Complex> &tensor = tensors[qubit];
+	unsigned long left = bonds[qubit];
+	unsigned long right = bonds[qubit + 1];
+
+	double chances[2] = {0, 0};
+	for (unsigned long l = 0; l < left; l++) {
+		for (unsigned int value = 0; value < 2; value++) {
+			for (unsigned long r = 0; r < right; r++) chances[value] += tensor[(2 * l + value) * right + r].lengthSquared();
+		}
+	}
+
+	double chance = chances[1] / (chances[0] + chances[1]);
+	unsigned int result = generator.random() > chance ? 0 : 1;
+
+	double scale = 1 / std::sqrt(chances[result]);
+	for (unsigned long l = 0; l < left; l++) {
+		for (unsigned int value = 0; value < 2; value++) {
+			for (unsigned long r = 0; r < right; r++) {
+				Complex &amplitude = tensor[(2 * l + value) * right + r];
+				amplitude = value == result ? amplitude * scale : Complex(0);
+			}
+		}
+	}
+	return result;
+}
+
+void MatrixProductState::sample(std::vector<unsigned int> &values) {
+	moveCenter(0);
+	values.resize(qubitCount);
+
+	// The product of the matrices selected by the drawn values, normalized
+	std::vector<Complex> product = {1};
+	for (unsigned long qubit = 0; qubit < qubitCount; qubit++) {
+		const std::vector<Complex> &tensor = tensors[qubit];
+		unsigned long left = bonds[qubit];
+		unsigned long right = bonds[qubit + 1];
+
+		std::vector<Complex> next[2] = {std::vector<Complex>(right), std::vector<Complex>(right)};
+		double chances[2] = {0, 0};
+		for (unsigned int value = 0; value < 2; value++) {
+			for (unsigned long l = 0; l < left; l++) {
+				for (unsigned long r = 0; r < right; r++) {
+					next[value][r] = next[value][r] + product[l] * tensor[(2 * l + value) * right + r];
+				}
+			}
+			for (unsigned long r = 0; r < right; r++) chances[value] += next[value][r].lengthSquared();
+		}
+
+		double chance = chances[1] / (chances[0] + chances[1]);
+		unsigned int value = generator.random() > chance ? 0 : 1;
+		values[qubit] = value;
+
+		product.resize(right);
+		double scale = 1 / std::sqrt(chances[value]);
+		for (unsigned long r = 0; r < right; r++) product[r] = next[value][r] * scale;
+	}
+}
+
+void MatrixProductState::resetQubit(unsigned long qubit) {
+	if (measure(qubit) == 1) applyAntiDiagonal(qubit, 1, 1);
+}
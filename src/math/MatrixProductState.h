@@ -0,0 +1,228 @@
+#ifndef QUANTUMSIMULATOR_MATRIXPRODUCTSTATE_H
+#define QUANTUMSIMULATOR_MATRIXPRODUCTSTATE_H
+
+
+#include <vector>
+#include <random>
+#include "Complex.h"
+#include "Random.h"
+
+namespace math {
+
+	/**
+	 * A state of the qubits stored as a matrix product state: every qubit has a tensor
+	 * with a left bond, a physical (0 or 1) and a right bond index, and the amplitude
+	 * of a basis state is the product of the matrices selected by the qubits' values.
+	 * The size of the bonds grows with the entanglement between the two sides, so
+	 * weakly entangled states of many qubits (like the ones made by shallow circuits
+	 * of nearest-neighbour gates) only take polynomial memory.
+	 *
+	 * Two qubit gates are applied to neighbouring tensors, and the result is split
+	 * again with a singular value decomposition. The smallest singular values are
+	 * dropped if the bond would be bigger than the cap, or if their total weight is
+	 * below the truncation threshold. The dropped weight is accumulated as the
+	 * truncation error of the shot. Gates on distant qubits are applied by moving
+	 * the qubits next to each other with swaps, and moving them back afterwards.
+	 *
+	 * The state is kept in mixed canonical form: the tensors left of the center
+	 * are left-orthonormal and the ones right of it are right-orthonormal,
+	 * so the truncations are optimal and a qubit's probabilities can be read
+	 * from it's own tensor once the center is moved there.
+	 */
+	class MatrixProductState {
+	private:
+
+		unsigned long bitCount;
+		unsigned int *bitValues;
+
+		unsigned long qubitCount;
+		unsigned long maxBondDimension;
+		double truncationThreshold;
+
+		std::vector<std::vector<Complex>> tensors;
+		std::vector<unsigned long> bonds;
+		unsigned long center;
+
+		double truncationError;
+		double largestTruncationError;
+
+		Random generator;
+
+		/**
+		 * Moves the orthogonality center to the given qubit, by decomposing
+		 * the tensors in between and multiplying the non-orthonormal part into the next one.
+		 *
+		 * @param qubit The id of the qubit
+		 */
+		void moveCenter(unsigned long qubit);
+
+		/**
+		 * Applies a two qubit gate to neighbouring qubits, then splits their tensors
+		 * and truncates the bond between them. The center ends up on the second qubit.
+		 *
+		 * @param qubit The id of the first qubit (the second one is qubit + 1)
+		 * @param matrix The 4x4 transformation, the first qubit is the lower bit of the indices
+		 */
+		void applyAdjacent(unsigned long qubit, const Complex matrix[4][4]);
+
+		/**
+		 * Applies a two qubit gate to any two different qubits.
+		 *
+		 * @param qubit1 The id of the qubit of the lower bit of the matrix indices
+		 * @param qubit2 The id of the qubit of the higher bit of the matrix indices
+		 * @param matrix The 4x4 transformation
+		 */
+		void applyGate(unsigned long qubit1, unsigned long qubit2, const Complex matrix[4][4]);
+
+	public:
+
+		/**
+		 * Creates a matrix product state with the given bit and qubit count, with every qubit in the 0 state.
+		 *
+		 * @param bitCount The number of real bits
+		 * @param qubitCount The number of quantum bits
+		 * @param maxBondDimension The largest allowed bond dimension
+		 * @param truncationThreshold The largest weight of singular values dropped by a decomposition
+		 * @param seed The seed of the state's random number generator
+		 */
+		MatrixProductState(unsigned long bitCount, unsigned long qubitCount, unsigned long maxBondDimension,
+		                   double truncationThreshold, unsigned long seed = std::random_device()());
+
+		/**
+		 * Deletes the real bits.
+		 */
+		~MatrixProductState();
+
+		MatrixProductState(const MatrixProductState &) = delete;
+		MatrixProductState &operator=(const MatrixProductState &) = delete;
+
+		/**
+		 * Sets every real bit to 0, every qubit to the 0 state and the truncation error of the shot to 0.
+		 */
+		void reset();
+
+		/**
+		 * Jumps to the beginning of the given stream of the state's random number generator.
+		 *
+		 * @param stream The id of the stream
+		 */
+		void setStream(unsigned long stream);
+
+		/**
+		 * Returns the number of real bits.
+		 *
+		 * @return The bit count
+		 */
+		unsigned long getBitCount() const;
+
+		/**
+		 * Returns the number of quantum bits.
+		 *
+		 * @return The qubit count
+		 */
+		unsigned long getQubitCount() const;
+
+		/**
+		 * Returns the largest bond dimension of the state.
+		 *
+		 * @return The bond dimension
+		 */
+		unsigned long getBondDimension() const;
+
+		/**
+		 * Returns the total weight of the singular values dropped since the last reset.
+		 * It's an upper bound of the squared distance from the exact state.
+		 *
+		 * @return The truncation error of the shot
+		 */
+		double getTruncationError() const;
+
+		/**
+		 * Returns the largest truncation error of the shots since the state was created.
+		 *
+		 * @return The largest truncation error
+		 */
+		double getLargestTruncationError() const;
+
+		/**
+		 * Returns the value of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @return The value of a real bit
+		 */
+		unsigned int getBit(unsigned long bit) const;
+
+		/**
+		 * Set's the value of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @param value The value of the real bit
+		 */
+		void setBit(unsigned long bit, unsigned int value);
+
+		/**
+		 * Applies a 2x2 matrix transformation to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param matrix The transformation (2x2 complex matrix)
+		 */
+		void applyTransform(unsigned long qubit, const Complex matrix[2][2]);
+
+		/**
+		 * Applies a diagonal 2x2 matrix transformation to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value0 The matrix element scaling the qubit's 0 state
+		 * @param value1 The matrix element scaling the qubit's 1 state
+		 */
+		void applyDiagonal(unsigned long qubit, const Complex &value0, const Complex &value1);
+
+		/**
+		 * Applies an anti-diagonal 2x2 matrix transformation to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param value01 The matrix element mapping the qubit's 0 state to it's 1 state
+		 * @param value10 The matrix element mapping the qubit's 1 state to it's 0 state
+		 */
+		void applyAntiDiagonal(unsigned long qubit, const Complex &value01, const Complex &value10);
+
+		/**
+		 * Applies a controlled not gate.
+		 *
+		 * @param qubit The id of the flipped qubit
+		 * @param control The id of the control qubit
+		 */
+		void applyNot(unsigned long qubit, unsigned long control);
+
+		/**
+		 * Measures a qubit in the computational basis and collapses the state.
+		 * The result is drawn with the state's random number generator.
+		 *
+		 * @param qubit The id of the qubit
+		 * @return The measured value
+		 */
+		unsigned int measure(unsigned long qubit);
+
+		/**
+		 * Draws the values of every qubit from the state's probability distribution without collapsing it.
+		 * The qubits are drawn from left to right, each from it's distribution conditioned
+		 * on the values of the previous ones, which only takes the product of their matrices,
+		 * since the tensors right of the center are right-orthonormal.
+		 *
+		 * @param values The values of the qubits (set by the function)
+		 */
+		void sample(std::vector<unsigned int> &values);
+
+		/**
+		 * Resets a qubit to the 0 state, by measuring it and flipping it if it was 1.
+		 *
+		 * @param qubit The id of the qubit
+		 */
+		void resetQubit(unsigned long qubit);
+	};
+}
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_MATRIXPRODUCTSTATE_H
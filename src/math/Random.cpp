@@ -0,0 +1,59 @@
+#include "Random.h"
+
+static const uint32_t multiplier0 = 0xD2511F53;
+static const uint32_t multiplier1 = 0xCD9E8D57;
+static const uint32_t weyl0 = 0x9E3779B9;
+static const uint32_t weyl1 = 0xBB67AE85;
+
+Random::Random(uint64_t seed, uint64_t stream) : stream(stream) {
+	setSeed(seed);
+}
+
+void Random::setSeed(uint64_t seed) {
+	key[0] = (uint32_t) seed;
+	key[1] = (uint32_t) (seed >> 32u);
+	setStream(stream);
+}
+
+void Random::setStream(uint64_t stream) {
+	this->stream = stream;
+	position = 0;
+	used = 4;
+}
+
+void Random::generate() {
+	uint32_t counter[4] = {
+			(uint32_t) position, (uint32_t) (position >> 32u),
+			(uint32_t) stream, (uint32_t) (stream >> 32u)
+	};
+	uint32_t roundKey[2] = {key[0], key[1]};
+
+	for (int round = 0; round < 10; round++) {
+		uint64_t product0 = (uint64_t) multiplier0 * counter[0];
+		uint64_t product1 = (uint64_t) multiplier1 * counter[2];
+		uint32_t next[4] = {
+				(uint32_t) (product1 >> 32u) ^ counter[1] ^ roundKey[0], (uint32_t) product1,
+				(uint32_t) (product0 >> 32u) ^ counter[3] ^ roundKey[1], (uint32_t) product0
+		};
+		for (int i = 0; i < 4; i++) counter[i] = next[i];
+		roundKey[0] += weyl0;
+		roundKey[1] += weyl1;
+	}
+
+	for (int i = 0; i < 4; i++) block[i] = counter[i];
+	position++;
+	used = 0;
+}
+
+uint32_t Random::next() {
+	if (used == 4) generate();
+	return block[used++];
+}
+
+double Random::random() {
+	// The words are drawn in separate statements, so their order doesn't depend on the compiler
+	uint64_t high = next();
+	uint64_t low = next();
+	uint64_t bits = (high << 32u) | low;
+	return ((bits >> 11u) + 1) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,73 @@
+#ifndef QUANTUMSIMULATOR_RANDOM_H
+#define QUANTUMSIMULATOR_RANDOM_H
+
+
+#include <cstdint>
+
+namespace math {
+
+	/**
+	 * A counter based random number generator (Philox4x32-10).
+	 * Every number is computed from the seed, the stream and it's position
+	 * in the stream, so jumping to any stream is free, and different streams
+	 * (eg.: one for each shot) are independent of each other.
+	 */
+	class Random {
+	private:
+
+		uint32_t key[2];
+		uint64_t stream;
+		uint64_t position;
+
+		uint32_t block[4];
+		unsigned int used;
+
+		/**
+		 * Generates the next 4 random words into the block.
+		 */
+		void generate();
+
+		/**
+		 * Returns the next 32 random bits.
+		 *
+		 * @return The random bits
+		 */
+		uint32_t next();
+
+	public:
+
+		/**
+		 * Creates a generator from the given seed, starting at the beginning of the given stream.
+		 *
+		 * @param seed The seed of the generator
+		 * @param stream The id of the stream
+		 */
+		explicit Random(uint64_t seed = 0, uint64_t stream = 0);
+
+		/**
+		 * Changes the seed and jumps to the beginning of the current stream.
+		 *
+		 * @param seed The seed of the generator
+		 */
+		void setSeed(uint64_t seed);
+
+		/**
+		 * Jumps to the beginning of the given stream.
+		 *
+		 * @param stream The id of the stream
+		 */
+		void setStream(uint64_t stream);
+
+		/**
+		 * Returns a uniformly distributed random number in the (0, 1] interval.
+		 *
+		 * @return The random number
+		 */
+		double random();
+	};
+}
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_RANDOM_H
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <stdexcept>
+#include "Tableau.h"
+
+namespace {
+
+	/**
+	 * The Pauli matrices in the order of the Clifford tables (X, Z, Y).
+	 */
+	const Complex PAULIS[3][2][2] = {
+			{{0, 1}, {1, 0}},
+			{{1, 0}, {0, -1}},
+			{{0, Complex(0, -1)}, {Complex(0, 1), 0}}
+	};
+
+	/**
+	 * The x and z bits of the Pauli matrices in the order of the Clifford tables.
+	 */
+	const unsigned char PAULI_BITS[3][2] = {{1, 0}, {0, 1}, {1, 1}};
+}
+
+bool Tableau::toClifford(const Complex matrix[2][2], Clifford &clifford) {
+	// The matrices are indexed by [input][output], so the operator is the transpose
+	Complex a[2][2] = {{matrix[0][0], matrix[1][0]}, {matrix[0][1], matrix[1][1]}};
+
+	clifford.x[0] = clifford.z[0] = clifford.sign[0] = 0;
+	for (unsigned int pauli = 0; pauli < 3; pauli++) {
+		// The image of the Pauli operator: a * P * a^dagger
+		const Complex (&p)[2][2] = PAULIS[pauli];
+		Complex image[2][2];
+		for (int row = 0; row < 2; row++) {
+			for (int column = 0; column < 2; column++) {
+				Complex sum;
+				for (int i = 0; i < 2; i++) {
+					for (int j = 0; j < 2; j++) {
+						Complex adjoint(a[column][j].r, -a[column][j].i);
+						sum = sum + a[row][i] * p[i][j] * adjoint;
+					}
+				}
+				image[row][column] = sum;
+			}
+		}
+
+		bool found = false;
+		for (unsigned int candidate = 0; candidate < 3 && !found; candidate++) {
+			for (int sign = 1; sign >= -1 && !found; sign -= 2) {
+				double error = 0;
+				for (int row = 0; row < 2; row++) {
+					for (int column = 0; column < 2; column++) {
+						error += (image[row][column] - PAULIS[candidate][row][column] * (double) sign).lengthSquared();
+					}
+				}
+				if (error > 1e-16) continue;
+
+				unsigned int index = PAULI_BITS[pauli][0] + 2 * PAULI_BITS[pauli][1];
+				clifford.x[index] = PAULI_BITS[candidate][0];
+				clifford.z[index] = PAULI_BITS[candidate][1];
+				clifford.sign[index] = sign < 0;
+				found = true;
+			}
+		}
+		if (!found) return false;
+	}
+	return true;
+}
+
+Tableau::Tableau(unsigned long bitCount, unsigned long qubitCount, unsigned long seed) :
+		bitCount(bitCount), qubitCount(qubitCount), wordCount((qubitCount + 63) / 64), generator(seed) {
+
+	bitValues = new unsigned int[bitCount];
+	xs = new uint64_t[(2 * qubitCount + 1) * wordCount];
+	zs = new uint64_t[(2 * qubitCount + 1) * wordCount];
+	signs = new unsigned char[2 * qubitCount + 1];
+	reset();
+}
+
+Tableau::~Tableau() {
+	delete[] bitValues;
+	delete[] xs;
+	delete[] zs;
+	delete[] signs;
+}
+
+void Tableau::reset() {
+	std::fill(bitValues, bitValues + bitCount, 0);
+
+	// The destabilizers are X_i and the stabilizers are Z_i
+	for (unsigned long row = 0; row <= 2 * qubitCount; row++) clear(row);
+	for (unsigned long qubit = 0; qubit < qubitCount; qubit++) {
+		xs[qubit * wordCount + qubit / 64] = 1ul << (qubit % 64);
+		zs[(qubitCount + qubit) * wordCount + qubit / 64] = 1ul << (qubit % 64);
+	}
+}
+
+void Tableau::setStream(unsigned long stream) {
+	generator.setStream(stream);
+}
+
+unsigned long Tableau::getBitCount() const {
+	return bitCount;
+}
+
+unsigned long Tableau::getQubitCount() const {
+	return qubitCount;
+}
+
+unsigned int Tableau::getBit(unsigned long bit) const {
+	return bitValues[bit];
+}
+
+void Tableau::setBit(unsigned long bit, unsigned int value) {
+	if (value > 1) throw std::out_of_range("too big");
+	bitValues[bit] = value;
+}
+
+unsigned int Tableau::getX(unsigned long row, unsigned long qubit) const {
+	return (xs[row * wordCount + qubit / 64] >> (qubit % 64)) & 1ul;
+}
+
+void Tableau::multiply(unsigned long target, unsigned long source) {
+	// The phase of the product is i^(2 * target sign + 2 * source sign + sum of g), where g is the
+	// power of i picked up by the product of the two Pauli operators on a qubit (+1, -1 or 0).
+	// The qubits with +1 and -1 are collected as bit masks and counted.
+	long phase = 2 * signs[target] + 2 * signs[source];
+	uint64_t *x1 = xs + source * wordCount, *z1 = zs + source * wordCount;
+	uint64_t *x2 = xs + target * wordCount, *z2 = zs + target * wordCount;
+	for (unsigned long word = 0; word < wordCount; word++) {
+		uint64_t plus = (x1[word] & z1[word] & ~x2[word] & z2[word]) |
+		                (x1[word] & ~z1[word] & x2[word] & z2[word]) |
+		                (~x1[word] & z1[word] & x2[word] & ~z2[word]);
+		uint64_t minus = (x1[word] & z1[word] & x2[word] & ~z2[word]) |
+		                 (x1[word] & ~z1[word] & ~x2[word] & z2[word]) |
+		                 (~x1[word] & z1[word] & x2[word] & z2[word]);
+		phase += __builtin_popcountll(plus) - __builtin_popcountll(minus);
+		x2[word] ^= x1[word];
+		z2[word] ^= z1[word];
+	}
+	signs[target] = ((phase % 4 + 4) % 4) == 2;
+}
+
+void Tableau::copy(unsigned long target, unsigned long source) {
+	std::copy(xs + source * wordCount, xs + (source + 1) * wordCount, xs + target * wordCount);
+	std::copy(zs + source * wordCount, zs + (source + 1) * wordCount, zs + target * wordCount);
+	signs[target] = signs[source];
+}
+
+void Tableau::clear(unsigned long row) {
+	std::fill(xs + row * wordCount, xs + (row + 1) * wordCount, 0);
+	std::fill(zs + row * wordCount, zs + (row + 1) * wordCount, 0);
+	signs[row] = 0;
+}
+
+void Tableau::applyClifford(unsigned long qubit, const Clifford &clifford) {
+	unsigned long word = qubit / 64;
+	unsigned long shift = qubit % 64;
+	for (unsigned long row = 0; row < 2 * qubitCount; row++) {
+		uint64_t &x = xs[row * wordCount + word];
+		uint64_t &z = zs[row * wordCount + word];
+		unsigned int index = ((x >> shift) & 1ul) + 2 * ((z >> shift) & 1ul);
+		x = (x & ~(1ul << shift)) | ((uint64_t) clifford.x[index] << shift);
+		z = (z & ~(1ul << shift)) | ((uint64_t) clifford.z[index] << shift);
+		signs[row] ^= clifford.sign[index];
+	}
+}
+
+void Tableau::applyNot(unsigned long qubit, unsigned long control) {
+	for (unsigned long row = 0; row < 2 * qubitCount; row++) {
+		uint64_t *x = xs + row * wordCount;
+		uint64_t *z = zs + row * wordCount;
+		unsigned int xa = (x[control / 64] >> (control % 64)) & 1ul;
+		unsigned int za = (z[control / 64] >> (control % 64)) & 1ul;
+		unsigned int xb = (x[qubit / 64] >> (qubit % 64)) & 1ul;
+		unsigned int zb = (z[qubit / 64] >> (qubit % 64)) & 1ul;
+
+		signs[row] ^= xa & zb & (xb ^ za ^ 1);
+		x[qubit / 64] ^= (uint64_t) xa << (qubit % 64);
+		z[control / 64] ^= (uint64_t) zb << (control % 64);
+	}
+}
+
+unsigned int Tableau::measure(unsigned long qubit) {
+	unsigned long n = qubitCount;
+
+	// If a stabilizer anticommutes with Z on the qubit, the result is random
+	unsigned long pivot = n;
+	while (pivot < 2 * n && !getX(pivot, qubit)) pivot++;
+
+	if (pivot < 2 * n) {
+		for (unsigned long row = 0; row < 2 * n; row++) {
+			if (row != pivot && getX(row, qubit)) multiply(row, pivot);
+		}
+		copy(pivot - n, pivot);
+		clear(pivot);
+		zs[pivot * wordCount + qubit / 64] = 1ul << (qubit % 64);
+
+		unsigned int result = generator.random() > 0.5 ? 0 : 1;
+		signs[pivot] = result;
+		return result;
+	}
+
+	// Otherwise Z on the qubit is the product of the stabilizers paired with the anticommuting destabilizers
+	clear(2 * n);
+	for (unsigned long row = 0; row < n; row++) {
+		if (getX(row, qubit)) multiply(2 * n, row + n);
+	}
+	return signs[2 * n];
+}
+
+void Tableau::resetQubit(unsigned long qubit) {
+	// Flipping the qubit (applying X) negates the rows containing Z or Y on it
+	if (measure(qubit) == 1) {
+		for (unsigned long row = 0; row < 2 * qubitCount; row++) {
+			signs[row] ^= (zs[row * wordCount + qubit / 64] >> (qubit % 64)) & 1ul;
+		}
+	}
+}
@@ -0,0 +1,188 @@
+#ifndef QUANTUMSIMULATOR_TABLEAU_H
+#define QUANTUMSIMULATOR_TABLEAU_H
+
+
+#include <cstdint>
+#include <random>
+#include "Complex.h"
+#include "Random.h"
+
+namespace math {
+
+	/**
+	 * A stabilizer state of the qubits, stored as an Aaronson-Gottesman tableau.
+	 * It can only be manipulated by Clifford gates, but it only takes O(n^2) bits instead of
+	 * 2^n amplitudes, so it can simulate thousands of qubits.
+	 *
+	 * Rows [0, n) are the destabilizers, rows [n, 2n) the stabilizers and row 2n is used
+	 * as a scratch row by the measurements. Every row is a Pauli string: the x and z bits
+	 * of the qubits are packed into 64 bit words, and it has a sign bit.
+	 */
+	class Tableau {
+	public:
+
+		/**
+		 * The action of a single qubit Clifford gate on the Pauli operators,
+		 * indexed by the x and z bits of the operator (x + 2z): I, X, Z, Y.
+		 * The operator is mapped to the operator with the given x and z bits,
+		 * and it's sign is flipped if the sign bit is set.
+		 */
+		struct Clifford {
+			unsigned char x[4];
+			unsigned char z[4];
+			unsigned char sign[4];
+		};
+
+	private:
+
+		unsigned long bitCount;
+		unsigned int *bitValues;
+
+		unsigned long qubitCount;
+		unsigned long wordCount;
+		uint64_t *xs;
+		uint64_t *zs;
+		unsigned char *signs;
+
+		Random generator;
+
+		/**
+		 * Returns the x bit of a qubit in a row.
+		 *
+		 * @param row The id of the row
+		 * @param qubit The id of the qubit
+		 * @return The x bit
+		 */
+		unsigned int getX(unsigned long row, unsigned long qubit) const;
+
+		/**
+		 * Multiplies a row by another one (the rowsum operation).
+		 *
+		 * @param target The id of the multiplied row
+		 * @param source The id of the row it's multiplied by
+		 */
+		void multiply(unsigned long target, unsigned long source);
+
+		/**
+		 * Copies a row to another one.
+		 *
+		 * @param target The id of the overwritten row
+		 * @param source The id of the copied row
+		 */
+		void copy(unsigned long target, unsigned long source);
+
+		/**
+		 * Clears a row (sets it to the identity with positive sign).
+		 *
+		 * @param row The id of the row
+		 */
+		void clear(unsigned long row);
+
+	public:
+
+		/**
+		 * Returns the Pauli operator action of the given unitary, if it's a Clifford gate.
+		 *
+		 * @param matrix The unitary transformation (2x2 complex matrix)
+		 * @param clifford The action of the gate, set if it's a Clifford gate
+		 * @return True if the unitary is a Clifford gate (up to a global phase)
+		 */
+		static bool toClifford(const Complex matrix[2][2], Clifford &clifford);
+
+		/**
+		 * Creates a tableau with the given bit and qubit count, with every qubit in the 0 state.
+		 *
+		 * @param bitCount The number of real bits
+		 * @param qubitCount The number of quantum bits
+		 * @param seed The seed of the tableau's random number generator
+		 */
+		Tableau(unsigned long bitCount, unsigned long qubitCount, unsigned long seed = std::random_device()());
+
+		/**
+		 * Deletes the real bits and the rows.
+		 */
+		~Tableau();
+
+		Tableau(const Tableau &) = delete;
+		Tableau &operator=(const Tableau &) = delete;
+
+		/**
+		 * Sets every real bit to 0 and every qubit to the 0 state.
+		 */
+		void reset();
+
+		/**
+		 * Jumps to the beginning of the given stream of the tableau's random number generator.
+		 *
+		 * @param stream The id of the stream
+		 */
+		void setStream(unsigned long stream);
+
+		/**
+		 * Returns the number of real bits.
+		 *
+		 * @return The bit count
+		 */
+		unsigned long getBitCount() const;
+
+		/**
+		 * Returns the number of quantum bits.
+		 *
+		 * @return The qubit count
+		 */
+		unsigned long getQubitCount() const;
+
+		/**
+		 * Returns the value of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @return The value of a real bit
+		 */
+		unsigned int getBit(unsigned long bit) const;
+
+		/**
+		 * Set's the value of a real bit.
+		 *
+		 * @param bit The id of the real bit
+		 * @param value The value of the real bit
+		 */
+		void setBit(unsigned long bit, unsigned int value);
+
+		/**
+		 * Applies a single qubit Clifford gate to a qubit.
+		 *
+		 * @param qubit The id of the qubit
+		 * @param clifford The action of the gate
+		 */
+		void applyClifford(unsigned long qubit, const Clifford &clifford);
+
+		/**
+		 * Applies a controlled not gate.
+		 *
+		 * @param qubit The id of the flipped qubit
+		 * @param control The id of the control qubit
+		 */
+		void applyNot(unsigned long qubit, unsigned long control);
+
+		/**
+		 * Measures a qubit in the computational basis and collapses the state.
+		 * If the result isn't determined by the state, it's drawn with the tableau's random number generator.
+		 *
+		 * @param qubit The id of the qubit
+		 * @return The measured value
+		 */
+		unsigned int measure(unsigned long qubit);
+
+		/**
+		 * Resets a qubit to the 0 state, by measuring it and flipping it if it was 1.
+		 *
+		 * @param qubit The id of the qubit
+		 */
+		void resetQubit(unsigned long qubit);
+	};
+}
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_TABLEAU_H
@@ -0,0 +1,94 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned long threadCount) :
+		job(nullptr), count(0), generation(0), remaining(0), stopping(false) {
+
+	for (unsigned long thread = 1; thread < threadCount; thread++) {
+		workers.emplace_back(&ThreadPool::work, this, thread);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	started.notify_all();
+	for (std::thread &worker : workers) worker.join();
+}
+
+unsigned long ThreadPool::getThreadCount() const {
+	return workers.size() + 1;
+}
+
+unsigned long ThreadPool::getBound(unsigned long thread) const {
+	if (thread >= getThreadCount()) return count;
+	return (count * thread / getThreadCount()) & ~63ul;
+}
+
+void ThreadPool::work(unsigned long thread) {
+	unsigned long seen = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		started.wait(lock, [&] { return stopping || generation != seen; });
+		if (stopping) return;
+		seen = generation;
+
+		lock.unlock();
+		(*job)(thread, getBound(thread), getBound(thread + 1));
+		lock.lock();
+
+		if (--remaining == 0) finished.notify_one();
+	}
+}
+
+bool ThreadPool::execute(unsigned long count, const Job &job) {
+	std::unique_lock<std::mutex> busyLock(busy, std::try_to_lock);
+	if (!busyLock.owns_lock()) return false;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->count = count;
+		remaining = workers.size();
+		generation++;
+	}
+	started.notify_all();
+
+	job(0, getBound(0), getBound(1));
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return remaining == 0; });
+	return true;
+}
+
+void ThreadPool::run(unsigned long count, const Task &task) {
+	Job job = [&task](unsigned long, unsigned long begin, unsigned long end) {
+		if (begin < end) task(begin, end);
+	};
+
+	if (workers.empty() || !execute(count, job)) task(0, count);
+}
+
+double ThreadPool::sum(unsigned long count, const SumTask &task) {
+	std::vector<double> partials(getThreadCount(), 0);
+	Job job = [&task, &partials](unsigned long thread, unsigned long begin, unsigned long end) {
+		if (begin < end) partials[thread] = task(begin, end);
+	};
+
+	if (workers.empty() || !execute(count, job)) return task(0, count);
+
+	double sum = 0;
+	for (double partial : partials) sum += partial;
+	return sum;
+}
+
+void ThreadPool::each(const ThreadTask &task) {
+	Job job = [&task](unsigned long thread, unsigned long, unsigned long) {
+		task(thread);
+	};
+
+	if (workers.empty() || !execute(0, job)) {
+		for (unsigned long thread = 0; thread < getThreadCount(); thread++) task(thread);
+	}
+}
@@ -0,0 +1,139 @@
+#ifndef QUANTUMSIMULATOR_THREADPOOL_H
+#define QUANTUMSIMULATOR_THREADPOOL_H
+
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace math {
+
+	/**
+	 * A fixed set of worker threads that split loops between each other.
+	 * The calling thread always takes part in the work, so a pool
+	 * with n threads starts only n - 1 workers.
+	 */
+	class ThreadPool {
+	public:
+
+		/**
+		 * A task working on the [begin, end) part of a loop.
+		 */
+		typedef std::function<void(unsigned long begin, unsigned long end)> Task;
+
+		/**
+		 * A task working on the [begin, end) part of a loop and returning a partial sum.
+		 */
+		typedef std::function<double(unsigned long begin, unsigned long end)> SumTask;
+
+		/**
+		 * A task executed once by every thread, with the id of the thread.
+		 */
+		typedef std::function<void(unsigned long thread)> ThreadTask;
+
+	private:
+
+		/**
+		 * A task working on the [begin, end) part of a loop on the given thread.
+		 */
+		typedef std::function<void(unsigned long thread, unsigned long begin, unsigned long end)> Job;
+
+		std::vector<std::thread> workers;
+
+		std::mutex busy;
+		std::mutex mutex;
+		std::condition_variable started;
+		std::condition_variable finished;
+
+		const Job *job;
+		unsigned long count;
+		unsigned long generation;
+		unsigned long remaining;
+		bool stopping;
+
+		/**
+		 * Returns the first index of the given thread's part of the loop.
+		 * The bounds are aligned, so that the parts don't share cache lines.
+		 *
+		 * @param thread The id of the thread (the thread count for the end of the loop)
+		 * @return The first index of the thread's part
+		 */
+		unsigned long getBound(unsigned long thread) const;
+
+		/**
+		 * Splits the [0, count) loop between the threads and waits for all of them to finish.
+		 * Returns false without doing anything if the pool is busy.
+		 *
+		 * @param count The length of the loop
+		 * @param job The job executed on the parts of the loop
+		 * @return True if the loop was executed
+		 */
+		bool execute(unsigned long count, const Job &job);
+
+		/**
+		 * The main loop of a worker thread.
+		 *
+		 * @param thread The id of the worker thread
+		 */
+		void work(unsigned long thread);
+
+	public:
+
+		/**
+		 * Creates a pool and starts its worker threads.
+		 *
+		 * @param threadCount The number of threads working on a loop (including the caller)
+		 */
+		explicit ThreadPool(unsigned long threadCount);
+
+		/**
+		 * Stops and joins the worker threads.
+		 */
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+
+		/**
+		 * Returns the number of threads working on a loop (including the caller).
+		 *
+		 * @return The thread count
+		 */
+		unsigned long getThreadCount() const;
+
+		/**
+		 * Splits the [0, count) loop between the threads and waits for all of them to finish.
+		 * If the pool is already running a loop for another thread,
+		 * the whole loop is executed by the caller instead.
+		 *
+		 * @param count The length of the loop
+		 * @param task The task executed on the parts of the loop
+		 */
+		void run(unsigned long count, const Task &task);
+
+		/**
+		 * Splits the [0, count) loop between the threads and returns the sum of the partial results.
+		 * The partial results are added in a fixed order, so the result only depends on the thread count.
+		 *
+		 * @param count The length of the loop
+		 * @param task The task executed on the parts of the loop
+		 * @return The sum of the partial results
+		 */
+		double sum(unsigned long count, const SumTask &task);
+
+		/**
+		 * Executes the task once on every thread (the caller's id is 0) and waits for all of them to finish.
+		 * If the pool is already running a loop for another thread, the caller executes it for every id instead.
+		 *
+		 * @param task The task executed by the threads
+		 */
+		void each(const ThreadTask &task);
+	};
+}
+
+using namespace math;
+
+
+#endif //QUANTUMSIMULATOR_THREADPOOL_H
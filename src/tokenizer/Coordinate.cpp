@@ -1,6 +1,28 @@
 #include "Coordinate.h"
 
-Coordinate::Coordinate(const std::string &file, int line, int column) : file(file), line(line), column(column) {
+std::deque<std::string> &Coordinate::getFiles() {
+	// The id of the empty path (used by default constructed coordinates) is 0
+	static std::deque<std::string> files(1);
+	return files;
+}
+
+unsigned long Coordinate::intern(const std::string &file) {
+	if (file.empty()) return 0;
+
+	static std::map<std::string, unsigned long> ids;
+	auto id = ids.find(file);
+	if (id != ids.end()) return id->second;
+
+	getFiles().push_back(file);
+	ids[file] = getFiles().size() - 1;
+	return getFiles().size() - 1;
+}
+
+Coordinate::Coordinate(const std::string &file, int line, int column) : file(intern(file)), line(line), column(column) {
+
+}
+
+Coordinate::Coordinate(unsigned long file, int line, int column) : file(file), line(line), column(column) {
 
 }
 
@@ -16,6 +38,10 @@ Coordinate &Coordinate::operator=(const Coordinate &coordinate) {
 }
 
 const std::string &Coordinate::getFile() const {
+	return getFiles()[file];
+}
+
+unsigned long Coordinate::getFileId() const {
 	return file;
 }
 
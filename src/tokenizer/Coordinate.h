@@ -3,22 +3,41 @@
 
 
 #include <string>
+#include <deque>
+#include <map>
 
 namespace tokenizer {
 
 	/**
 	 * Represents a character in a source code by the source code's file,
 	 * the character's line and the characters position in the line.
+	 * The files are interned, so a coordinate only stores the id of it's file.
 	 */
 	class Coordinate {
 	private:
 
-		std::string file;
+		unsigned long file;
 		int line;
 		int column;
 
+		/**
+		 * Returns the paths of the interned files (indexed by their ids).
+		 * A deque is used, so that interning doesn't move the existing paths.
+		 *
+		 * @return The interned paths
+		 */
+		static std::deque<std::string> &getFiles();
+
 	public:
 
+		/**
+		 * Returns the id of the given file, and interns it if it's new.
+		 *
+		 * @param file The path of the file
+		 * @return The id of the file
+		 */
+		static unsigned long intern(const std::string &file);
+
 		/**
 		 * Creates a coordinate from the given constructor parameters.
 		 *
@@ -28,6 +47,15 @@ namespace tokenizer {
 		 */
 		Coordinate(const std::string &file = "", int line = 0, int column = 0);
 
+		/**
+		 * Creates a coordinate in an already interned file.
+		 *
+		 * @param file The id of the file where the represented character is
+		 * @param line The line where the character is
+		 * @param column Position of the character in the line
+		 */
+		Coordinate(unsigned long file, int line, int column);
+
 		/**
 		 * Copies the input coordinate's values and creates a new coordinate.
 		 *
@@ -49,6 +77,12 @@ namespace tokenizer {
 		 */
 		const std::string &getFile() const;
 
+		/**
+		 * Returns the id of the file where the source code is.
+		 * @return The source code's file's id
+		 */
+		unsigned long getFileId() const;
+
 		/**
 		 * Returns the line where the represented character is.
 		 * @return The character's line's number
@@ -0,0 +1,65 @@
+#include "Source.h"
+#include "Coordinate.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+Source::Source(const std::string &file) : file(Coordinate::intern(file)), data(nullptr), size(0), mapped(false) {
+#ifdef SOURCE_MMAP
+
+	int descriptor = open(file.c_str(), O_RDONLY);
+	struct stat status;
+	if (descriptor < 0 || fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+		if (descriptor >= 0) close(descriptor);
+		throw std::runtime_error("The file: \"" + file + "\" doesn't exist.");
+	}
+
+	// Empty files can't be mapped
+	size = status.st_size;
+	if (size > 0) {
+		void *address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		if (address != MAP_FAILED) {
+			madvise(address, size, MADV_SEQUENTIAL);
+			data = (const char *) address;
+			mapped = true;
+		}
+	}
+	close(descriptor);
+
+	if (size > 0 && !mapped) throw std::runtime_error("The file: \"" + file + "\" couldn't be loaded.");
+
+#else
+
+	std::ifstream input(file);
+	if (!input.good()) throw std::runtime_error("The file: \"" + file + "\" doesn't exist.");
+
+	std::stringstream stream;
+	stream << input.rdbuf();
+	buffer = stream.str();
+	data = buffer.data();
+	size = buffer.size();
+
+#endif
+}
+
+Source::~Source() {
+#ifdef SOURCE_MMAP
+	if (mapped) munmap((void *) data, size);
+#endif
+}
+
+unsigned long Source::getFile() const {
+	return file;
+}
+
+std::string_view Source::getCode() const {
+	return std::string_view(data, size);
+}
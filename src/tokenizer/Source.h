@@ -0,0 +1,61 @@
+#ifndef QUANTUMSIMULATOR_SOURCE_H
+#define QUANTUMSIMULATOR_SOURCE_H
+
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+
+namespace tokenizer {
+
+	/**
+	 * The loaded contents of a source code file. Where it's possible,
+	 * the file is memory mapped instead of being copied into memory,
+	 * so the tokens can refer to it without copying anything.
+	 */
+	class Source {
+	private:
+
+		unsigned long file;
+		const char *data;
+		unsigned long size;
+		bool mapped;
+		std::string buffer;
+
+	public:
+
+		/**
+		 * Loads the given file. If the file doesn't exist, a runtime error is thrown.
+		 *
+		 * @param file The path of the file
+		 */
+		explicit Source(const std::string &file);
+
+		/**
+		 * Unmaps the file.
+		 */
+		~Source();
+
+		Source(const Source &) = delete;
+		Source &operator=(const Source &) = delete;
+
+		/**
+		 * Returns the interned id of the file.
+		 *
+		 * @return The id of the file
+		 */
+		unsigned long getFile() const;
+
+		/**
+		 * Returns the contents of the file.
+		 *
+		 * @return The source code
+		 */
+		std::string_view getCode() const;
+	};
+}
+
+using namespace tokenizer;
+
+
+#endif //QUANTUMSIMULATOR_SOURCE_H
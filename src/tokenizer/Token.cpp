@@ -1,6 +1,6 @@
 #include "Token.h"
 
-Token::Token(const Coordinate &coordinate, const Token::Type type, const std::string value) : coordinate(coordinate), type(type), value(value) {}
+Token::Token(const Coordinate &coordinate, const Token::Type type, std::string_view value) : coordinate(coordinate), type(type), value(value) {}
 
 Token::Token(const Token &token) {
 	*this = token;
@@ -21,20 +21,20 @@ Token::Type Token::getType() const {
 	return type;
 }
 
-const std::string &Token::getValue() const {
+std::string_view Token::getValue() const {
 	return value;
 }
 
-unsigned long Token::getInt() {
-	return std::stoul(value);
+unsigned long Token::getInt() const {
+	return std::stoul(std::string(value));
 }
 
-double Token::getReal() {
-	return std::stod(value);
+double Token::getReal() const {
+	return std::stod(std::string(value));
 }
 
-std::string Token::getString() {
-	if (value[0] != '\"') return value;
+std::string Token::getString() const {
+	if (value[0] != '\"') return std::string(value);
 
 	std::string string;
 	for (unsigned long i = 1; i < value.size() - 1; i++) {
@@ -2,6 +2,7 @@
 #define QUANTUMSIMULATOR_TOKEN_H
 
 #include <string>
+#include <string_view>
 #include "Coordinate.h"
 
 namespace tokenizer {
@@ -10,6 +11,8 @@ namespace tokenizer {
 	 * A part of a source code, that contains it's characters
 	 * in the code (value), it's position in the code (coordinate)
 	 * and it's type (type, eg.: 12.34 -> Type::INTEGER).
+	 * The value is a view into the source code, so the token can only
+	 * be used while the source code is loaded.
 	 */
 	class Token {
 	public:
@@ -27,7 +30,7 @@ namespace tokenizer {
 
 		Coordinate coordinate;
 		Type type;
-		std::string value;
+		std::string_view value;
 
 	public:
 
@@ -38,7 +41,7 @@ namespace tokenizer {
 		 * @param type The type of the token
 		 * @param value The string value of the token
 		 */
-		Token(const Coordinate &coordinate = Coordinate(), const Type type = NONE, const std::string value = "");
+		Token(const Coordinate &coordinate = Coordinate(), const Type type = NONE, std::string_view value = "");
 
 		/**
 		 * Copies the input token's values and creates a new token.
@@ -72,23 +75,23 @@ namespace tokenizer {
 		/**
 		 * Returns the corresponding string value of the token.
 		 *
-		 * @return The value of the token
+		 * @return The value of the token (a view into the source code)
 		 */
-		const std::string &getValue() const;
+		std::string_view getValue() const;
 
 		/**
 		 * Converts the string value of the token to an integer type.
 		 *
 		 * @return The value as an unsigned long
 		 */
-		unsigned long getInt();
+		unsigned long getInt() const;
 
 		/**
 		 * Converts the string value of the token to an real type.
 		 *
 		 * @return The value as a double
 		 */
-		double getReal();
+		double getReal() const;
 
 		/**
 		 * Converts the string value of the token to another string value,
@@ -98,7 +101,7 @@ namespace tokenizer {
 		 *
 		 * @return The value as a string
 		 */
-		std::string getString();
+		std::string getString() const;
 	};
 }
 
@@ -7,97 +7,181 @@ Tokenizer::Exception::Exception(const Coordinate &coordinate) noexcept :
 
 }
 
-Tokenizer::Matcher::Matcher(std::string regex, Token::Type type) : regex(std::regex(regex)), type(type) {}
-
-bool Tokenizer::Matcher::match(const Coordinate &coorinate, const std::string &code, Token &token) {
-	static std::smatch match;
-	if (std::regex_search(code, match, regex)) {
-		token = Token(coorinate, type, match[1]);
-		return true;
-	} else {
-		return false;
-	}
+Tokenizer::Tokenizer(const Source &source) :
+		code(source.getCode()), position(0), coordinate(source.getFile(), 1, 1) {
+
 }
 
-Tokenizer::Matcher Tokenizer::matchers[] = {
-		Matcher(R"(^(\s+))", Token::Type::NONE),
-		Matcher(R"(^(//(.|[^\n])*\n))", Token::Type::NONE),
-
-		Matcher(R"(^(OPENQASM)\W)", Token::Type::OPENQASM),
-		Matcher(R"(^(include)\W)", Token::Type::INCLUDE),
-
-		Matcher(R"(^(creg)\W)", Token::Type::CREG),
-		Matcher(R"(^(qreg)\W)", Token::Type::QREG),
-		Matcher(R"(^(gate)\W)", Token::Type::GATE),
-		Matcher(R"(^(opaque)\W)", Token::Type::OPAQUE),
-		Matcher(R"(^(if)\W)", Token::Type::IF),
-		Matcher(R"(^(reset)\W)", Token::Type::RESET),
-		Matcher(R"(^(measure)\W)", Token::Type::MEASURE),
-		Matcher(R"(^(barrier)\W)", Token::Type::BARRIER),
-
-		Matcher(R"(^(\())", Token::Type::LPARENTHESIS),
-		Matcher(R"(^(\)))", Token::Type::RPARENTHESIS),
-		Matcher(R"(^(\[))", Token::Type::LBRACKET),
-		Matcher(R"(^(\]))", Token::Type::RBRACKET),
-		Matcher(R"(^(\{))", Token::Type::GATE_BEGIN),
-		Matcher(R"(^(\}))", Token::Type::GATE_END),
-
-		Matcher(R"(^(\;))", Token::Type::SEMICOLON),
-		Matcher(R"(^(\,))", Token::Type::COMMA),
-		Matcher(R"(^(\+))", Token::Type::PLUS),
-		Matcher(R"(^(\-)[^>])", Token::Type::MINUS),
-		Matcher(R"(^(\*))", Token::Type::MUL),
-		Matcher(R"(^(\/))", Token::Type::DIV),
-		Matcher(R"(^(\^))", Token::Type::POW),
-		Matcher(R"(^(\=\=))", Token::Type::EQUALS),
-		Matcher(R"(^(\->))", Token::Type::ARROW),
-
-		Matcher(R"(^([a-zA-Z_]\w*))", Token::Type::NAME),
-		Matcher(R"(^(\d+)[^\w\.])", Token::Type::INTEGER),
-		Matcher(R"(^(\d*\.\d+)[^\w])", Token::Type::REAL),
-		Matcher(R"(^(\"((\\\")|[^\"])*\"))", Token::Type::STRING)
-};
-
-std::vector<Token> Tokenizer::tokenize(const std::string &file) {
-	std::vector<Token> tokens;
+char Tokenizer::peek(unsigned long offset) const {
+	return position + offset < code.size() ? code[position + offset] : '\0';
+}
 
-	std::ifstream input(file);
-	if (!input.good()) throw std::runtime_error("The file: \"" + file + "\" doesn't exist.");
-
-	std::stringstream buffer;
-	buffer << input.rdbuf();
-	std::string code = buffer.str();
-
-	Coordinate coordinate(file, 1, 1);
-	Token token;
-
-	while (!code.empty()) {
-		bool matched = false;
-		for (Matcher matcher : matchers) {
-			if (matcher.match(coordinate, code, token)) {
-				matched = true;
-				code = code.substr(token.getValue().size());
-				for (char c : token.getValue()) {
-					if (c == '\n') {
-						coordinate = Coordinate(coordinate.getFile(), coordinate.getLine() + 1, 1);
-					} else if (c == '\r') {
-						coordinate = Coordinate(coordinate.getFile(), coordinate.getLine(), 1);
-					} else {
-						coordinate = Coordinate(coordinate.getFile(), coordinate.getLine(), coordinate.getColumn() + 1);
-					}
-				}
-				break;
+bool Tokenizer::isSeparator(unsigned long offset) const {
+	if (position + offset >= code.size()) return false;
+	char c = code[position + offset];
+	return !isalnum((unsigned char) c) && c != '_';
+}
+
+unsigned long Tokenizer::countDigits(unsigned long offset) const {
+	unsigned long count = 0;
+	while (position + offset + count < code.size() && isdigit((unsigned char) code[position + offset + count])) count++;
+	return count;
+}
+
+unsigned long Tokenizer::match(Token::Type &type) const {
+	char c = peek();
+	unsigned long length = 0;
+
+	// Whitespaces
+	if (isspace((unsigned char) c)) {
+		type = Token::NONE;
+		while (position + length < code.size() && isspace((unsigned char) code[position + length])) length++;
+		return length;
+	}
+
+	// Names and keywords (a keyword at the very end of the file is a name)
+	if (isalpha((unsigned char) c) || c == '_') {
+		while (position + length < code.size() && (isalnum((unsigned char) code[position + length]) || code[position + length] == '_')) length++;
+
+		static const std::pair<const char *, Token::Type> keywords[] = {
+				{"OPENQASM", Token::OPENQASM}, {"include", Token::INCLUDE},
+				{"creg", Token::CREG}, {"qreg", Token::QREG}, {"gate", Token::GATE}, {"opaque", Token::OPAQUE},
+				{"if", Token::IF}, {"reset", Token::RESET}, {"measure", Token::MEASURE}, {"barrier", Token::BARRIER}
+		};
+
+		type = Token::NAME;
+		if (position + length < code.size()) {
+			for (const std::pair<const char *, Token::Type> &keyword : keywords) {
+				if (code.compare(position, length, keyword.first) == 0) type = keyword.second;
 			}
 		}
-		if (matched) {
-			if (token.getType() != Token::Type::NONE) {
-				tokens.push_back(token);
+		return length;
+	}
+
+	// Integers (followed by anything but a name character or a dot) and reals (followed by anything but a name character)
+	if (isdigit((unsigned char) c) || c == '.') {
+		unsigned long integer = countDigits(0);
+		if (integer > 0 && isSeparator(integer) && peek(integer) != '.') {
+			type = Token::INTEGER;
+			return integer;
+		}
+
+		if (peek(integer) != '.') return 0;
+		unsigned long fraction = countDigits(integer + 1);
+		if (fraction > 0 && isSeparator(integer + 1 + fraction)) {
+			type = Token::REAL;
+			return integer + 1 + fraction;
+		}
+		return 0;
+	}
+
+	switch (c) {
+		case '/':
+			// Comments (only if they are closed by a new line)
+			if (peek(1) == '/') {
+				std::string_view::size_type end = code.find('\n', position + 2);
+				if (end != std::string_view::npos) {
+					type = Token::NONE;
+					return end + 1 - position;
+				}
 			}
+			type = Token::DIV;
+			return 1;
+		case '(':
+			type = Token::LPARENTHESIS;
+			return 1;
+		case ')':
+			type = Token::RPARENTHESIS;
+			return 1;
+		case '[':
+			type = Token::LBRACKET;
+			return 1;
+		case ']':
+			type = Token::RBRACKET;
+			return 1;
+		case '{':
+			type = Token::GATE_BEGIN;
+			return 1;
+		case '}':
+			type = Token::GATE_END;
+			return 1;
+		case ';':
+			type = Token::SEMICOLON;
+			return 1;
+		case ',':
+			type = Token::COMMA;
+			return 1;
+		case '+':
+			type = Token::PLUS;
+			return 1;
+		case '*':
+			type = Token::MUL;
+			return 1;
+		case '^':
+			type = Token::POW;
+			return 1;
+		case '-':
+			// A minus has to be followed by something
+			if (position + 1 >= code.size()) return 0;
+			type = peek(1) == '>' ? Token::ARROW : Token::MINUS;
+			return type == Token::ARROW ? 2 : 1;
+		case '=':
+			if (peek(1) != '=') return 0;
+			type = Token::EQUALS;
+			return 2;
+		case '"': {
+			// Strings, where \" doesn't close the string,
+			// unless the string isn't closed otherwise (then the last one closes it)
+			unsigned long lastEscaped = 0;
+			for (unsigned long i = position + 1; i < code.size(); i++) {
+				if (code[i] == '\\' && i + 1 < code.size() && code[i + 1] == '"') {
+					lastEscaped = ++i;
+				} else if (code[i] == '"') {
+					type = Token::STRING;
+					return i + 1 - position;
+				}
+			}
+			if (lastEscaped == 0) return 0;
+			type = Token::STRING;
+			return lastEscaped + 1 - position;
+		}
+		default:
+			return 0;
+	}
+}
+
+void Tokenizer::advance(unsigned long length) {
+	int line = coordinate.getLine();
+	int column = coordinate.getColumn();
+	for (unsigned long i = position; i < position + length; i++) {
+		if (code[i] == '\n') {
+			line++;
+			column = 1;
+		} else if (code[i] == '\r') {
+			column = 1;
 		} else {
-			throw Exception(coordinate);
+			column++;
 		}
 	}
 
-	tokens.emplace_back(coordinate, Token::Type::END, "");
+	position += length;
+	coordinate = Coordinate(coordinate.getFileId(), line, column);
+}
+
+std::vector<Token> Tokenizer::tokenize(const Source &source) {
+	std::vector<Token> tokens;
+
+	Tokenizer tokenizer(source);
+	std::string_view code = tokenizer.code;
+	while (tokenizer.position < code.size()) {
+		Token::Type type;
+		unsigned long length = tokenizer.match(type);
+		if (length == 0) throw Exception(tokenizer.coordinate);
+
+		if (type != Token::NONE) tokens.emplace_back(tokenizer.coordinate, type, code.substr(tokenizer.position, length));
+		tokenizer.advance(length);
+	}
+
+	tokens.emplace_back(tokenizer.coordinate, Token::END, "");
 	return tokens;
 }
@@ -3,22 +3,22 @@
 
 
 #include <string>
-#include <regex>
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <string_view>
+#include <vector>
+#include <cctype>
 #include "Token.h"
+#include "Source.h"
 
 namespace tokenizer {
 
 	/**
-	 * Turns a given file to a vector of tokens.
+	 * Turns a given source code to a vector of tokens.
 	 */
 	class Tokenizer {
 	public:
 
 		/**
-		 * A runtime error, thrown when no matcher suitable for the source code found.
+		 * A runtime error, thrown when no token matches the source code.
 		 */
 		class Exception : public std::runtime_error {
 		public:
@@ -28,51 +28,72 @@ namespace tokenizer {
 
 	private:
 
+		std::string_view code;
+		unsigned long position;
+		Coordinate coordinate;
+
 		/**
-		 * Holds a token's type and the regex describing the token.
+		 * Creates a tokenizer at the beginning of the given source code.
+		 *
+		 * @param source The source code
 		 */
-		class Matcher {
-		private:
+		explicit Tokenizer(const Source &source);
 
-			std::regex regex;
-			Token::Type type;
+		/**
+		 * Returns the character at the given distance from the current position,
+		 * or 0 if it's past the end of the source code.
+		 *
+		 * @param offset The distance from the current position
+		 * @return The character
+		 */
+		char peek(unsigned long offset = 0) const;
 
-		public:
+		/**
+		 * Checks whether there is a character at the given distance from the current position
+		 * and it can't be part of a name (it isn't a letter, a digit or an underscore).
+		 *
+		 * @param offset The distance from the current position
+		 * @return True if the character ends a name
+		 */
+		bool isSeparator(unsigned long offset) const;
 
-			/**
-			 * Creates a matcher from the constructor parameters.
-			 *
-			 * @param regex The description of the token
-			 * @param type The type of the token
-			 */
-			Matcher(std::string regex, Token::Type type);
-
-			/**
-			 * Tries to match the regex to the given code. If successful,
-			 * true is returned and assigns the token reference to the matched token.
-			 * If not, false is returned.
-			 *
-			 * @param coordinate The point in the source code where the matching happens
-			 * @param code The given source code (not necessarily the entire code)
-			 * @param token A reference to which the matched token will be assigned
-			 * @return True if matched, false otherwise
-			 */
-			bool match(const Coordinate& coordinate, const std::string &code, Token &token);
-		};
+		/**
+		 * Returns the number of consecutive digits from the given distance from the current position.
+		 *
+		 * @param offset The distance from the current position
+		 * @return The number of digits
+		 */
+		unsigned long countDigits(unsigned long offset) const;
+
+		/**
+		 * Matches the token at the current position by looking at it's first character.
+		 * Whitespaces and comments are matched as NONE tokens.
+		 * If no token matches, 0 is returned.
+		 *
+		 * @param type A reference to which the type of the matched token will be assigned
+		 * @return The length of the matched token
+		 */
+		unsigned long match(Token::Type &type) const;
 
-		static Matcher matchers[];
+		/**
+		 * Moves the current position and coordinate after the given number of characters.
+		 *
+		 * @param length The number of characters
+		 */
+		void advance(unsigned long length);
 
 	public:
 
 		/**
-		 * Turns the given file into a vector of tokens,
-		 * by scanning it and trying to match it to all of the matchers.
-		 * If no matcher matches, a Tokenizer::Exception is thrown.
+		 * Turns the given source code into a vector of tokens, by scanning it once
+		 * and matching a token at the current position until reaching the end.
+		 * If no token matches, a Tokenizer::Exception is thrown.
+		 * The tokens refer to the source code, so it has to outlive them.
 		 *
-		 * @param file The given file's path
+		 * @param source The given source code
 		 * @return The vector of tokens
 		 */
-		static std::vector<Token> tokenize(const std::string &file);
+		static std::vector<Token> tokenize(const Source &source);
 	};
 }
 
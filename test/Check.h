@@ -0,0 +1,64 @@
+#ifndef QUANTUMSIMULATOR_CHECK_H
+#define QUANTUMSIMULATOR_CHECK_H
+
+
+#include <iostream>
+#include <string>
+#include <cmath>
+
+namespace test {
+
+	/**
+	 * Returns the number of failed checks of the test.
+	 *
+	 * @return A reference to the failure count
+	 */
+	inline unsigned long &failures() {
+		static unsigned long count = 0;
+		return count;
+	}
+
+	/**
+	 * Checks a condition of the test, and reports it as a failure if it's false.
+	 *
+	 * @param condition The checked condition
+	 * @param message The description of the condition
+	 */
+	inline void check(bool condition, const std::string &message) {
+		if (condition) return;
+		std::cerr << "FAILED: " << message << std::endl;
+		failures()++;
+	}
+
+	/**
+	 * Checks that a value is within the given distance of it's expected value.
+	 *
+	 * @param value The checked value
+	 * @param expected The expected value
+	 * @param tolerance The largest allowed distance
+	 * @param message The description of the value
+	 */
+	inline void checkNear(double value, double expected, double tolerance, const std::string &message) {
+		check(std::abs(value - expected) <= tolerance,
+		      message + " (" + std::to_string(value) + " instead of " + std::to_string(expected) + ")");
+	}
+
+	/**
+	 * Reports the result of the test.
+	 *
+	 * @return The exit code of the test (0 if every check passed)
+	 */
+	inline int finish() {
+		if (failures() == 0) {
+			std::cout << "All checks passed" << std::endl;
+			return 0;
+		}
+		std::cerr << failures() << " checks failed" << std::endl;
+		return 1;
+	}
+}
+
+using namespace test;
+
+
+#endif //QUANTUMSIMULATOR_CHECK_H
@@ -0,0 +1,149 @@
+#include <cmath>
+#include <vector>
+#include "Check.h"
+#include "../src/compiler/Instruction.h"
+#include "../src/compiler/Bytecode.h"
+#include "../src/math/DensityMatrix.h"
+
+const unsigned long SHOTS = 20000;
+
+/**
+ * Executes the instructions on a density matrix, without drawing the measurements, and deletes them.
+ *
+ * @param instructions The instructions
+ * @param state The density matrix (reset before the execution)
+ */
+void execute(const std::vector<Instruction *> &instructions, DensityMatrix &state) {
+	Bytecode bytecode(instructions, Bytecode::DENSITY_MATRIX);
+	state.reset();
+	bytecode.execute(state, false);
+	for (Instruction *instruction : instructions) delete instruction;
+}
+
+/**
+ * Executes the instructions as noise trajectories on a state vector in every shot,
+ * and returns how often each state was the result. The instructions are deleted.
+ *
+ * @param instructions The instructions (without measurements)
+ * @param qubitCount The number of qubits
+ * @return The frequencies of the states
+ */
+std::vector<double> sampleTrajectories(const std::vector<Instruction *> &instructions, unsigned long qubitCount) {
+	Bytecode bytecode(instructions);
+	Environment env(0, qubitCount, 3);
+	std::vector<double> frequencies(1ul << qubitCount, 0);
+	for (unsigned long shot = 0; shot < SHOTS; shot++) {
+		env.reset();
+		env.setStream(shot);
+		bytecode.execute(env);
+		for (unsigned long state = 0; state < frequencies.size(); state++) {
+			frequencies[state] += env.getStateChance(state) / SHOTS;
+		}
+	}
+	for (Instruction *instruction : instructions) delete instruction;
+	return frequencies;
+}
+
+/**
+ * Checks the chances of the states of a density matrix, and that it's trace is 1.
+ *
+ * @param name The name of the check
+ * @param state The density matrix
+ * @param expected The expected chances of the states
+ */
+void checkChances(const std::string &name, const DensityMatrix &state, const std::vector<double> &expected) {
+	double trace = 0;
+	for (unsigned long i = 0; i < state.getStateCount(); i++) {
+		checkNear(state.getStateChance(i), expected[i], 1e-12, name + ": chance of state " + std::to_string(i));
+		trace += state.getStateChance(i);
+	}
+	checkNear(trace, 1, 1e-12, name + ": trace");
+}
+
+/**
+ * Checks that the frequencies of the trajectories match the chances of the density matrix.
+ *
+ * @param name The name of the check
+ * @param frequencies The frequencies of the states
+ * @param expected The chances of the states
+ */
+void checkFrequencies(const std::string &name, const std::vector<double> &frequencies,
+                      const std::vector<double> &expected) {
+	for (unsigned long i = 0; i < expected.size(); i++) {
+		double deviation = std::sqrt(expected[i] * (1 - expected[i]) / SHOTS);
+		checkNear(frequencies[i], expected[i], 5 * deviation + 1e-9,
+		          name + ": trajectory frequency of state " + std::to_string(i));
+	}
+}
+
+int main() {
+	const double p = 0.3;
+	DensityMatrix single(1, 1, 5);
+	DensityMatrix pair(2, 2, 5);
+
+	// Depolarizing replaces the flipped qubit by the mixed state with probability p
+	execute({new U(M_PI, 0, M_PI, 0), new Channel(Channel::DEPOLARIZING, p, 0)}, single);
+	checkChances("depolarizing", single, {p / 2, 1 - p / 2});
+	checkFrequencies("depolarizing", sampleTrajectories(
+			{new U(M_PI, 0, M_PI, 0), new Channel(Channel::DEPOLARIZING, p, 0)}, 1), {p / 2, 1 - p / 2});
+
+	// Amplitude damping decays the 1 state, twice in a row it's kept with (1 - gamma)^2
+	execute({new U(M_PI, 0, M_PI, 0), new Channel(Channel::AMPLITUDE_DAMPING, p, 0),
+	         new Channel(Channel::AMPLITUDE_DAMPING, p, 0)}, single);
+	double kept = (1 - p) * (1 - p);
+	checkChances("amplitude damping", single, {1 - kept, kept});
+	checkFrequencies("amplitude damping", sampleTrajectories(
+			{new U(M_PI, 0, M_PI, 0), new Channel(Channel::AMPLITUDE_DAMPING, p, 0),
+			 new Channel(Channel::AMPLITUDE_DAMPING, p, 0)}, 1), {1 - kept, kept});
+
+	// Phase damping keeps the populations, but scales the coherence seen by the second H
+	execute({new U(M_PI / 2, 0, M_PI, 0), new Channel(Channel::PHASE_DAMPING, p, 0)}, single);
+	checkChances("phase damping populations", single, {0.5, 0.5});
+	double coherence = std::sqrt(1 - p);
+	execute({new U(M_PI / 2, 0, M_PI, 0), new Channel(Channel::PHASE_DAMPING, p, 0), new U(M_PI / 2, 0, M_PI, 0)},
+	        single);
+	checkChances("phase damping", single, {(1 + coherence) / 2, (1 - coherence) / 2});
+	checkFrequencies("phase damping", sampleTrajectories(
+			{new U(M_PI / 2, 0, M_PI, 0), new Channel(Channel::PHASE_DAMPING, p, 0), new U(M_PI / 2, 0, M_PI, 0)}, 1),
+	                 {(1 + coherence) / 2, (1 - coherence) / 2});
+
+	// Depolarizing one half of a Bell pair breaks the correlation with probability p / 2
+	std::vector<double> bell = {0.5 - p / 4, p / 4, p / 4, 0.5 - p / 4};
+	execute({new U(M_PI / 2, 0, M_PI, 0), new CX(0, 1), new Channel(Channel::DEPOLARIZING, p, 0)}, pair);
+	checkChances("Bell pair", pair, bell);
+	checkFrequencies("Bell pair", sampleTrajectories(
+			{new U(M_PI / 2, 0, M_PI, 0), new CX(0, 1), new Channel(Channel::DEPOLARIZING, p, 0)}, 2), bell);
+
+	// The Kraus operators of every channel preserve the trace: the superoperator maps
+	// the identity (states 0 and 3 of the row and column) to a matrix of trace 2
+	for (Channel::Kind kind : {Channel::DEPOLARIZING, Channel::AMPLITUDE_DAMPING, Channel::PHASE_DAMPING}) {
+		Channel channel(kind, p, 0);
+		std::vector<Complex> superoperator = DensityMatrix::getSuperoperator(channel.getOperators());
+		for (unsigned long input = 0; input < 4; input += 3) {
+			Complex trace = superoperator[input * 4] + superoperator[input * 4 + 3];
+			checkNear(trace.r, 1, 1e-12, "channel " + std::to_string(kind) + ": trace of the output");
+			checkNear(trace.i, 0, 1e-12, "channel " + std::to_string(kind) + ": imaginary trace of the output");
+		}
+	}
+
+	// The readout errors flip the measured bits with the probability of their value
+	const double flip0 = 0.1;
+	const double flip1 = 0.25;
+	std::vector<Instruction *> instructions = {new U(M_PI, 0, M_PI, 1), new Measure(0, 0), new Measure(1, 1),
+	                                           new ReadoutError(0, flip0, flip1), new ReadoutError(1, flip0, flip1)};
+	Bytecode bytecode(instructions, Bytecode::DENSITY_MATRIX);
+	for (Instruction *instruction : instructions) delete instruction;
+	unsigned long ones0 = 0;
+	unsigned long zeros1 = 0;
+	for (unsigned long shot = 0; shot < SHOTS; shot++) {
+		pair.reset();
+		pair.setStream(shot);
+		bytecode.execute(pair);
+		ones0 += pair.getBit(0);
+		zeros1 += 1 - pair.getBit(1);
+	}
+	checkNear((double) ones0 / SHOTS, flip0, 5 * std::sqrt(flip0 * (1 - flip0) / SHOTS), "readout of 0");
+	checkNear((double) zeros1 / SHOTS, flip1, 5 * std::sqrt(flip1 * (1 - flip1) / SHOTS), "readout of 1");
+
+	return finish();
+}
@@ -0,0 +1,137 @@
+#include <map>
+#include <random>
+#include <stdexcept>
+#include "Check.h"
+#include "../src/compiler/Histogram.h"
+
+/**
+ * Checks that a histogram holds the same outcomes and counts as a reference map, in order.
+ *
+ * @param name The name of the check
+ * @param histogram The histogram
+ * @param expected The counts of the outcomes (with the last word first, so the map is in the same order)
+ */
+void checkCounts(const std::string &name, const Histogram &histogram,
+                 const std::map<std::vector<unsigned long>, unsigned long> &expected) {
+	std::vector<std::pair<std::vector<unsigned long>, unsigned long>> outcomes = histogram.getOutcomes();
+	check(histogram.getSize() == expected.size(), name + ": " + std::to_string(histogram.getSize()) +
+	                                              " outcomes instead of " + std::to_string(expected.size()));
+	check(outcomes.size() == expected.size(), name + ": the sorted outcomes have the wrong size");
+
+	std::map<std::vector<unsigned long>, unsigned long>::const_iterator iterator = expected.begin();
+	for (unsigned long i = 0; i < outcomes.size() && iterator != expected.end(); i++, iterator++) {
+		std::vector<unsigned long> reversed(outcomes[i].first.rbegin(), outcomes[i].first.rend());
+		bool same = reversed == iterator->first && outcomes[i].second == iterator->second;
+		check(same, name + ": outcome " + std::to_string(i) + " differs");
+		if (!same) return;
+	}
+}
+
+/**
+ * Adds random outcomes (with few different values, so they repeat) and checks them against a map.
+ *
+ * @param wordCount The words of an outcome
+ * @param additions The number of additions
+ * @param values The number of different values of a word
+ */
+void checkRandom(unsigned long wordCount, unsigned long additions, unsigned long values) {
+	std::mt19937_64 generator(wordCount * 1000 + values);
+	Histogram histogram(wordCount);
+	std::map<std::vector<unsigned long>, unsigned long> expected;
+	std::vector<unsigned long> outcome(wordCount);
+	for (unsigned long i = 0; i < additions; i++) {
+		// The values are spread over the whole word, so some only differ in the high bits
+		for (unsigned long &word : outcome) word = (generator() % values) << (generator() % 2 == 0 ? 0 : 60);
+		unsigned long count = generator() % 3 + 1;
+		histogram.add(outcome.data(), count);
+		expected[std::vector<unsigned long>(outcome.rbegin(), outcome.rend())] += count;
+	}
+	checkCounts("random " + std::to_string(wordCount) + " words", histogram, expected);
+}
+
+int main() {
+	// Outcomes that only differ in the high bits, which a plain mask of the low bits would put in one slot
+	Histogram high;
+	std::map<std::vector<unsigned long>, unsigned long> expectedHigh;
+	for (unsigned long i = 0; i < 64; i++) {
+		high.add(1ul << i, i + 1);
+		high.add(1ul << i);
+		expectedHigh[{1ul << i}] = i + 2;
+	}
+	checkCounts("high bits", high, expectedHigh);
+
+	// The grow path: from the initial 16 slots to thousands, with repeated outcomes
+	Histogram grown;
+	std::map<std::vector<unsigned long>, unsigned long> expectedGrown;
+	for (unsigned long round = 0; round < 3; round++) {
+		for (unsigned long i = 0; i < 5000; i++) {
+			grown.add(i * 7919, round + 1);
+			expectedGrown[{i * 7919}] += round + 1;
+		}
+	}
+	checkCounts("grow", grown, expectedGrown);
+
+	checkRandom(1, 20000, 40);
+	checkRandom(2, 20000, 8);
+	checkRandom(5, 5000, 2);
+
+	// The single word add pads the other words with 0
+	Histogram padded(3);
+	unsigned long words[] = {5, 0, 0};
+	padded.add(5);
+	padded.add(words, 2);
+	unsigned long other[] = {5, 1, 0};
+	padded.add(other);
+	checkCounts("padding", padded, {{{0, 0, 5}, 3}, {{0, 1, 5}, 1}});
+
+	// The words are ordered with the last one as the most significant
+	Histogram ordered(2);
+	unsigned long low[] = {~0ul, 0};
+	unsigned long middle[] = {0, 1};
+	unsigned long top[] = {1, 1};
+	ordered.add(top);
+	ordered.add(low);
+	ordered.add(middle);
+	std::vector<std::pair<std::vector<unsigned long>, unsigned long>> outcomes = ordered.getOutcomes();
+	check(outcomes.size() == 3 && outcomes[0].first[0] == ~0ul && outcomes[1].first[0] == 0 &&
+	      outcomes[2].first[0] == 1, "order: the outcomes aren't sorted by their last word");
+
+	// Merging adds the counts of the shared outcomes and inserts the others
+	Histogram first(2);
+	Histogram second(2);
+	std::map<std::vector<unsigned long>, unsigned long> expectedMerged;
+	for (unsigned long i = 0; i < 300; i++) {
+		unsigned long outcome[] = {i, i % 3};
+		first.add(outcome, 2);
+		expectedMerged[{i % 3, i}] += 2;
+		if (i % 2 == 0) {
+			unsigned long shifted[] = {i + 150, i % 3};
+			second.add(shifted);
+			expectedMerged[{i % 3, i + 150}] += 1;
+		}
+	}
+	first.merge(second);
+	checkCounts("merge", first, expectedMerged);
+
+	bool thrown = false;
+	try {
+		Histogram(1).merge(Histogram(2));
+	} catch (const std::invalid_argument &) {
+		thrown = true;
+	}
+	check(thrown, "merge: histograms of different word counts are merged");
+
+	thrown = false;
+	try {
+		Histogram empty(0);
+	} catch (const std::invalid_argument &) {
+		thrown = true;
+	}
+	check(thrown, "words: an outcome without words is accepted");
+
+	Histogram unchanged;
+	unchanged.add(3, 0);
+	check(unchanged.getSize() == 0, "zero: an outcome without occurrences is stored");
+
+	return finish();
+}
@@ -0,0 +1,118 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "../src/math/Environment.h"
+#include "../src/math/MatrixProductState.h"
+
+const unsigned long QUBIT_COUNT = 6;
+const unsigned long SAMPLES = 40000;
+
+/**
+ * Sets the matrix of the U(theta, phi, lambda) gate.
+ *
+ * @param matrix The matrix (set by the function)
+ * @param theta The first angle
+ * @param phi The second angle
+ * @param lambda The third angle
+ */
+void setU(Complex matrix[2][2], double theta, double phi, double lambda) {
+	double c = std::cos(theta / 2);
+	double s = std::sin(theta / 2);
+	matrix[0][0] = Complex(c, 0);
+	matrix[0][1] = Complex(-std::cos(lambda) * s, -std::sin(lambda) * s);
+	matrix[1][0] = Complex(std::cos(phi) * s, std::sin(phi) * s);
+	matrix[1][1] = Complex(std::cos(phi + lambda) * c, std::sin(phi + lambda) * c);
+}
+
+/**
+ * Applies the same random circuit of U and CX gates (also on distant qubits) to a state vector
+ * and a matrix product state, then checks that the samples of the matrix product state
+ * follow the probabilities of the state vector.
+ *
+ * @param seed The seed of the circuit
+ * @param gateCount The number of gates
+ */
+void checkCircuit(unsigned long seed, unsigned long gateCount) {
+	std::mt19937_64 generator(seed);
+	std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+	Environment env(0, QUBIT_COUNT, seed);
+	// A bond of 2^(n/2) is never truncated
+	MatrixProductState mps(0, QUBIT_COUNT, 1ul << (QUBIT_COUNT / 2), 0, seed);
+
+	for (unsigned long i = 0; i < gateCount; i++) {
+		unsigned long qubit = generator() % QUBIT_COUNT;
+		if (generator() % 3 == 0) {
+			unsigned long control = (qubit + 1 + generator() % (QUBIT_COUNT - 1)) % QUBIT_COUNT;
+			env.applyNot(qubit, 1ul << control);
+			mps.applyNot(qubit, control);
+		} else {
+			Complex matrix[2][2];
+			setU(matrix, angle(generator), angle(generator), angle(generator));
+			env.applyTransform(qubit, matrix);
+			mps.applyTransform(qubit, matrix);
+		}
+	}
+
+	std::string name = "circuit " + std::to_string(seed);
+	checkNear(mps.getTruncationError(), 0, 1e-12, name + ": truncation error");
+	check(mps.getBondDimension() <= 1ul << (QUBIT_COUNT / 2), name + ": the bond is too big");
+
+	std::vector<unsigned long> counts(1ul << QUBIT_COUNT, 0);
+	std::vector<unsigned int> values;
+	for (unsigned long sample = 0; sample < SAMPLES; sample++) {
+		mps.sample(values);
+		unsigned long state = 0;
+		for (unsigned long qubit = 0; qubit < QUBIT_COUNT; qubit++) state |= (unsigned long) values[qubit] << qubit;
+		counts[state]++;
+	}
+	for (unsigned long state = 0; state < counts.size(); state++) {
+		double chance = env.getStateChance(state);
+		double deviation = std::sqrt(chance * (1 - chance) / SAMPLES);
+		checkNear((double) counts[state] / SAMPLES, chance, 5 * deviation + 1e-3,
+		          name + ": chance of state " + std::to_string(state));
+	}
+}
+
+int main() {
+	for (unsigned long seed = 1; seed <= 4; seed++) checkCircuit(seed, 60);
+
+	// A GHZ state truncated to a bond of 1 keeps one of it's halves, renormalized
+	const unsigned long ghzQubits = 8;
+	double half = 1 / std::sqrt(2.0);
+	const Complex h[2][2] = {{half, half}, {half, -half}};
+	MatrixProductState truncated(0, ghzQubits, 1, 0, 7);
+	truncated.applyTransform(0, h);
+	for (unsigned long qubit = 1; qubit < ghzQubits; qubit++) truncated.applyNot(qubit, qubit - 1);
+	checkNear(truncated.getTruncationError(), 0.5, 1e-9, "GHZ: truncation error");
+	check(truncated.getBondDimension() == 1, "GHZ: the bond isn't capped");
+
+	std::vector<unsigned int> values;
+	bool equal = true;
+	for (unsigned long sample = 0; sample < 100; sample++) {
+		truncated.sample(values);
+		for (unsigned long qubit = 1; qubit < ghzQubits; qubit++) equal = equal && values[qubit] == values[0];
+	}
+	check(equal, "GHZ: the truncated state isn't a product state");
+	unsigned int value = truncated.measure(ghzQubits - 1);
+	for (unsigned long qubit = 0; qubit + 1 < ghzQubits; qubit++) {
+		equal = equal && truncated.measure(qubit) == value;
+	}
+	check(equal, "GHZ: the measurements of the truncated state differ");
+
+	// The error is only reset with the state, but the largest one is kept
+	truncated.reset();
+	checkNear(truncated.getTruncationError(), 0, 0, "reset: truncation error");
+	checkNear(truncated.getLargestTruncationError(), 0.5, 1e-9, "reset: largest truncation error");
+
+	// A threshold drops the weak singular values, but keeps the error below it's total
+	MatrixProductState thresholded(0, ghzQubits, 64, 1e-2, 7);
+	Complex weak[2][2];
+	setU(weak, 0.1, 0, 0);
+	for (unsigned long qubit = 0; qubit < ghzQubits; qubit++) thresholded.applyTransform(qubit, weak);
+	for (unsigned long qubit = 1; qubit < ghzQubits; qubit++) thresholded.applyNot(qubit, qubit - 1);
+	check(thresholded.getTruncationError() > 0, "threshold: nothing is truncated");
+	check(thresholded.getTruncationError() <= (ghzQubits - 1) * 1e-2, "threshold: too much is truncated");
+
+	return finish();
+}
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Check.h"
+#include "../src/compiler/Instruction.h"
+#include "../src/compiler/Optimizer.h"
+#include "../src/compiler/Bytecode.h"
+#include "../src/math/Environment.h"
+#include "../src/math/Kernels.h"
+
+const unsigned long QUBIT_COUNT = 7;
+
+/**
+ * Creates a random circuit of single qubit gates and CX gates. A third of the single qubit gates
+ * are diagonal or anti-diagonal, so every kind of kernel is fused.
+ *
+ * @param seed The seed of the circuit
+ * @param gateCount The number of gates
+ * @return The instructions of the circuit
+ */
+std::vector<Instruction *> createCircuit(unsigned long seed, unsigned long gateCount) {
+	std::mt19937_64 generator(seed);
+	std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+	std::uniform_int_distribution<unsigned long> qubit(0, QUBIT_COUNT - 1);
+
+	std::vector<Instruction *> instructions;
+	for (unsigned long i = 0; i < gateCount; i++) {
+		switch (generator() % 4) {
+			case 0: {
+				unsigned long control = qubit(generator);
+				unsigned long target = (control + 1 + generator() % (QUBIT_COUNT - 1)) % QUBIT_COUNT;
+				instructions.push_back(new CX(control, target));
+				break;
+			}
+			case 1:
+				instructions.push_back(new U(generator() % 2 ? 0 : M_PI, angle(generator), angle(generator),
+				                             qubit(generator)));
+				break;
+			default:
+				instructions.push_back(new U(angle(generator), angle(generator), angle(generator), qubit(generator)));
+				break;
+		}
+	}
+	return instructions;
+}
+
+/**
+ * Executes the instructions on a new environment.
+ *
+ * @param instructions The instructions
+ * @param env The environment (reset before the execution)
+ */
+template<typename Scalar>
+void execute(const std::vector<Instruction *> &instructions, BasicEnvironment<Scalar> &env) {
+	Bytecode bytecode(instructions);
+	env.reset();
+	bytecode.execute(env);
+}
+
+/**
+ * Compares the final state of a circuit with the final state of the same circuit fused into gates
+ * of at most the given number of qubits.
+ *
+ * @param seed The seed of the circuit
+ * @param maxQubits The largest number of qubits of a fused gate
+ * @param tolerance The largest allowed difference of a coefficient
+ */
+template<typename Scalar>
+void checkFusion(unsigned long seed, unsigned long maxQubits, double tolerance) {
+	std::vector<Instruction *> original = createCircuit(seed, 300);
+	std::vector<Instruction *> fused = Optimizer::optimize(createCircuit(seed, 300), QUBIT_COUNT, maxQubits);
+	std::string name = "circuit " + std::to_string(seed) + " fused into " + std::to_string(maxQubits) + " qubit gates";
+
+	// Single qubit blocks are fused into U gates, the bigger ones into unitary gates
+	unsigned long fusedCount = 0;
+	for (Instruction *instruction : fused) if (instruction->getType() == Instruction::FUSED) fusedCount++;
+	check(fused.size() < original.size() && (maxQubits == 1 || fusedCount > 0), name + " has fused gates");
+
+	BasicEnvironment<Scalar> expected(0, QUBIT_COUNT, 1);
+	BasicEnvironment<Scalar> actual(0, QUBIT_COUNT, 1);
+	execute(original, expected);
+	execute(fused, actual);
+
+	// A fused U gate is only equal to the product of the gates up to a global phase,
+	// so the states are compared by their overlap and their probabilities
+	Complex overlap;
+	double largest = 0;
+	for (unsigned long state = 0; state < expected.getStateCount(); state++) {
+		Complex coefficient = expected.getStateCoefficient(state);
+		overlap = overlap + Complex(coefficient.r, -coefficient.i) * actual.getStateCoefficient(state);
+		largest = std::max(largest, std::abs(expected.getStateChance(state) - actual.getStateChance(state)));
+	}
+	checkNear(overlap.length(), 1, tolerance, name + " gives the same state");
+	checkNear(largest, 0, tolerance, name + " gives the same probabilities");
+	checkNear(actual.getTotalChance(), 1, tolerance, name + " keeps the norm");
+
+	for (Instruction *instruction : original) delete instruction;
+	for (Instruction *instruction : fused) delete instruction;
+}
+
+int main() {
+	// Every kernel level is checked (the unsupported ones fall back to the best supported one)
+	for (kernels::Level level : {kernels::SCALAR, kernels::AVX2, kernels::AVX512}) {
+		kernels::setLevel(level);
+		for (unsigned long seed = 1; seed <= 3; seed++) {
+			for (unsigned long maxQubits = 1; maxQubits <= Optimizer::MAX_QUBITS; maxQubits++) {
+				checkFusion<double>(seed, maxQubits, 1e-10);
+				checkFusion<float>(seed, maxQubits, 1e-4);
+			}
+		}
+	}
+	return finish();
+}
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cstdint>
+#include "Check.h"
+#include "../src/math/Random.h"
+
+/**
+ * Returns the 53 random bits of a random number in the (0, 1] interval (plus 1).
+ *
+ * @param generator The generator
+ * @return The random number scaled to (0, 2^53]
+ */
+uint64_t nextBits(Random &generator) {
+	return (uint64_t) (generator.random() * 9007199254740992.0);
+}
+
+/**
+ * The expected bits are the top 53 bits of the first two and the last two words of a Philox4x32-10 block
+ * (plus 1). The block of the zero key and counter is the known answer of the reference implementation,
+ * the others were computed by an independent implementation checked against all of it's known answers.
+ */
+void checkKnownAnswers() {
+	// Key (0, 0), counter (0, 0, 0, 0): 6627e8d5 e169c58d bc57ac4c 9b00dbd8
+	Random zero(0, 0);
+	check(nextBits(zero) == ((0x6627e8d5e169c58dul >> 11u) + 1), "first number of the zero key and stream");
+	check(nextBits(zero) == ((0xbc57ac4c9b00dbd8ul >> 11u) + 1), "second number of the zero key and stream");
+
+	// Key (a4093822, 299f31d0), stream (13198a2e, 03707344), positions 0 and 1
+	Random generator(0x299f31d0a4093822ul, 0x0370734413198a2eul);
+	check(nextBits(generator) == 6404965036472239ul, "first number of the seeded stream");
+	check(nextBits(generator) == 5814110835419710ul, "second number of the seeded stream");
+	check(nextBits(generator) == 1734734763874055ul, "third number of the seeded stream (next block)");
+	check(nextBits(generator) == 5621224604956954ul, "fourth number of the seeded stream (next block)");
+}
+
+void checkStreams() {
+	Random generator(42);
+	generator.setStream(7);
+	double first = generator.random();
+	double second = generator.random();
+
+	// Jumping back to a stream restarts it, whatever was drawn in between
+	generator.setStream(3);
+	generator.random();
+	generator.setStream(7);
+	check(generator.random() == first && generator.random() == second, "a stream is restarted by setStream");
+
+	// A new generator of the same seed and stream gives the same numbers
+	Random copy(42, 7);
+	check(copy.random() == first, "the numbers only depend on the seed and the stream");
+
+	Random other(42, 8);
+	check(other.random() != first, "different streams give different numbers");
+
+	// Changing the seed keeps the stream
+	generator.setSeed(43);
+	Random seeded(43, 7);
+	check(generator.random() == seeded.random(), "setSeed keeps the current stream");
+}
+
+void checkDistribution() {
+	Random generator(1);
+	const unsigned long count = 200000;
+	double sum = 0;
+	unsigned long buckets[10] = {};
+	bool inRange = true;
+	for (unsigned long i = 0; i < count; i++) {
+		double value = generator.random();
+		if (!(value > 0 && value <= 1)) inRange = false;
+		sum += value;
+		buckets[std::min(9ul, (unsigned long) (value * 10))]++;
+	}
+	check(inRange, "the numbers are in the (0, 1] interval");
+	checkNear(sum / count, 0.5, 0.005, "mean of the numbers");
+	for (unsigned long bucket = 0; bucket < 10; bucket++) {
+		checkNear((double) buckets[bucket] / count, 0.1, 0.005, "frequency of bucket " + std::to_string(bucket));
+	}
+}
+
+int main() {
+	checkKnownAnswers();
+	checkStreams();
+	checkDistribution();
+	return finish();
+}
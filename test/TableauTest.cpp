@@ -0,0 +1,126 @@
+#include <cmath>
+#include "Check.h"
+#include "../src/math/Tableau.h"
+
+static const unsigned long SHOTS = 4000;
+
+/**
+ * Returns the action of a single qubit gate, which has to be a Clifford gate.
+ *
+ * @param matrix The unitary transformation
+ * @return The action of the gate on the Pauli operators
+ */
+Tableau::Clifford toClifford(const Complex matrix[2][2]) {
+	Tableau::Clifford clifford;
+	check(Tableau::toClifford(matrix, clifford), "a Clifford gate isn't recognized");
+	return clifford;
+}
+
+/**
+ * Checks that a count of shots is within 5 standard deviations of the expected probability.
+ *
+ * @param name The name of the check
+ * @param count The number of shots with the event
+ * @param probability The expected probability of the event
+ */
+void checkFrequency(const std::string &name, unsigned long count, double probability) {
+	double deviation = std::sqrt(SHOTS * probability * (1 - probability));
+	checkNear((double) count, SHOTS * probability, 5 * deviation + 1e-9, name);
+}
+
+int main() {
+	double half = 1 / std::sqrt(2.0);
+	const Complex hMatrix[2][2] = {{half, half}, {half, -half}};
+	const Complex xMatrix[2][2] = {{0, 1}, {1, 0}};
+	const Complex sMatrix[2][2] = {{1, 0}, {0, Complex(0, 1)}};
+	const Complex tMatrix[2][2] = {{1, 0}, {0, Complex(half, half)}};
+	Tableau::Clifford h = toClifford(hMatrix);
+	Tableau::Clifford x = toClifford(xMatrix);
+	Tableau::Clifford s = toClifford(sMatrix);
+	Tableau::Clifford t;
+	check(!Tableau::toClifford(tMatrix, t), "the T gate is taken for a Clifford gate");
+
+	// 130 qubits span 3 words of a row
+	Tableau tableau(0, 130, 1);
+
+	unsigned long plus = 0;
+	unsigned long bell = 0;
+	unsigned long ghz = 0;
+	unsigned long y = 0;
+	bool deterministic = true;
+	bool correlated = true;
+	bool repeated = true;
+	bool reset = true;
+	for (unsigned long shot = 0; shot < SHOTS; shot++) {
+		tableau.reset();
+		tableau.setStream(shot);
+
+		// Computational basis states are measured with certainty
+		tableau.applyClifford(0, x);
+		deterministic = deterministic && tableau.measure(0) == 1 && tableau.measure(1) == 0;
+
+		// H S S H is X, so it flips the qubit without randomness
+		tableau.applyClifford(2, h);
+		tableau.applyClifford(2, s);
+		tableau.applyClifford(2, s);
+		tableau.applyClifford(2, h);
+		deterministic = deterministic && tableau.measure(2) == 1;
+
+		// The plus state gives either value, and the measurement collapses it
+		tableau.applyClifford(3, h);
+		unsigned int value = tableau.measure(3);
+		plus += value;
+		repeated = repeated && tableau.measure(3) == value;
+
+		// A Y eigenstate gives either value in the computational basis
+		tableau.applyClifford(4, h);
+		tableau.applyClifford(4, s);
+		y += tableau.measure(4);
+
+		// A Bell pair gives equal values
+		tableau.applyClifford(5, h);
+		tableau.applyNot(6, 5);
+		value = tableau.measure(6);
+		bell += value;
+		correlated = correlated && tableau.measure(5) == value;
+
+		// A GHZ state over the words of the rows gives equal values
+		tableau.applyClifford(7, h);
+		for (unsigned long qubit = 8; qubit < 130; qubit++) tableau.applyNot(qubit, qubit - 1);
+		value = tableau.measure(129);
+		ghz += value;
+		for (unsigned long qubit = 7; qubit < 129; qubit++) correlated = correlated && tableau.measure(qubit) == value;
+
+		// The reset brings a superposition and an excited qubit back to 0
+		tableau.applyClifford(3, h);
+		tableau.resetQubit(3);
+		tableau.resetQubit(0);
+		reset = reset && tableau.measure(3) == 0 && tableau.measure(0) == 0;
+	}
+
+	check(deterministic, "a determined measurement gave a random value");
+	check(repeated, "a repeated measurement gave a different value");
+	check(correlated, "the entangled qubits gave different values");
+	check(reset, "a reset qubit isn't in the 0 state");
+	checkFrequency("plus state", plus, 0.5);
+	checkFrequency("Y eigenstate", y, 0.5);
+	checkFrequency("Bell pair", bell, 0.5);
+	checkFrequency("GHZ state", ghz, 0.5);
+
+	// The same stream gives the same results
+	unsigned long first = 0;
+	unsigned long second = 0;
+	for (unsigned long run = 0; run < 2; run++) {
+		tableau.reset();
+		tableau.setStream(12345);
+		unsigned long results = 0;
+		for (unsigned long qubit = 0; qubit < 64; qubit++) {
+			tableau.applyClifford(qubit, h);
+			results |= (unsigned long) tableau.measure(qubit) << qubit;
+		}
+		(run == 0 ? first : second) = results;
+	}
+	check(first == second, "the same stream gave different measurements");
+
+	return finish();
+}
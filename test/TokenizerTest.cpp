@@ -0,0 +1,226 @@
+#include <regex>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include "Check.h"
+#include "../src/tokenizer/Tokenizer.h"
+
+/**
+ * A token of the reference tokenizer, with it's value copied.
+ */
+struct ReferenceToken {
+	Token::Type type;
+	std::string value;
+	int line;
+	int column;
+};
+
+/**
+ * Tokenizes the code with the regular expressions of the original tokenizer,
+ * which matched the expressions one after the other at the current position.
+ * If nothing matches, the coordinate of the position is returned as an error token.
+ *
+ * @param code The source code
+ * @return The tokens (the last one is END, or NONE at the position of an error)
+ */
+std::vector<ReferenceToken> tokenizeWithRegex(std::string code) {
+	static const std::pair<const char *, Token::Type> matchers[] = {
+			{R"(^(\s+))", Token::NONE},
+			{R"(^(//(.|[^\n])*\n))", Token::NONE},
+			{R"(^(OPENQASM)\W)", Token::OPENQASM},
+			{R"(^(include)\W)", Token::INCLUDE},
+			{R"(^(creg)\W)", Token::CREG},
+			{R"(^(qreg)\W)", Token::QREG},
+			{R"(^(gate)\W)", Token::GATE},
+			{R"(^(opaque)\W)", Token::OPAQUE},
+			{R"(^(if)\W)", Token::IF},
+			{R"(^(reset)\W)", Token::RESET},
+			{R"(^(measure)\W)", Token::MEASURE},
+			{R"(^(barrier)\W)", Token::BARRIER},
+			{R"(^(\())", Token::LPARENTHESIS},
+			{R"(^(\)))", Token::RPARENTHESIS},
+			{R"(^(\[))", Token::LBRACKET},
+			{R"(^(\]))", Token::RBRACKET},
+			{R"(^(\{))", Token::GATE_BEGIN},
+			{R"(^(\}))", Token::GATE_END},
+			{R"(^(\;))", Token::SEMICOLON},
+			{R"(^(\,))", Token::COMMA},
+			{R"(^(\+))", Token::PLUS},
+			{R"(^(\-)[^>])", Token::MINUS},
+			{R"(^(\*))", Token::MUL},
+			{R"(^(\/))", Token::DIV},
+			{R"(^(\^))", Token::POW},
+			{R"(^(\=\=))", Token::EQUALS},
+			{R"(^(\->))", Token::ARROW},
+			{R"(^([a-zA-Z_]\w*))", Token::NAME},
+			{R"(^(\d+)[^\w\.])", Token::INTEGER},
+			{R"(^(\d*\.\d+)[^\w])", Token::REAL},
+			{R"(^(\"((\\\")|[^\"])*\"))", Token::STRING}
+	};
+
+	std::vector<ReferenceToken> tokens;
+	int line = 1;
+	int column = 1;
+	while (!code.empty()) {
+		bool matched = false;
+		for (const std::pair<const char *, Token::Type> &matcher : matchers) {
+			std::smatch match;
+			if (!std::regex_search(code, match, std::regex(matcher.first))) continue;
+
+			std::string value = match[1];
+			if (matcher.second != Token::NONE) tokens.push_back({matcher.second, value, line, column});
+			for (char c : value) {
+				if (c == '\n') {
+					line++;
+					column = 1;
+				} else if (c == '\r') {
+					column = 1;
+				} else {
+					column++;
+				}
+			}
+			code = code.substr(value.size());
+			matched = true;
+			break;
+		}
+		if (!matched) {
+			tokens.push_back({Token::NONE, "", line, column});
+			return tokens;
+		}
+	}
+	tokens.push_back({Token::END, "", line, column});
+	return tokens;
+}
+
+/**
+ * Writes the code to a temporary file.
+ *
+ * @param name The name of the code
+ * @param code The source code
+ * @return The path of the file
+ */
+std::string writeFile(const std::string &name, const std::string &code) {
+	std::string file = (std::filesystem::temp_directory_path() / ("TokenizerTest_" + name + ".qasm")).string();
+	std::ofstream out(file, std::ios::binary);
+	out << code;
+	return file;
+}
+
+/**
+ * Tokenizes the code with both tokenizers, and checks that they give the same tokens
+ * at the same coordinates, or fail at the same coordinate.
+ *
+ * @param name The name of the checked code
+ * @param code The source code
+ */
+void checkSameTokens(const std::string &name, const std::string &code) {
+	std::string file = writeFile(name, code);
+
+	std::vector<ReferenceToken> expected = tokenizeWithRegex(code);
+	bool failed = false;
+	int line = 0;
+	int column = 0;
+	try {
+		Source source(file);
+		std::vector<Token> tokens = Tokenizer::tokenize(source);
+
+		check(tokens.size() == expected.size(), name + ": " + std::to_string(tokens.size()) + " tokens instead of " +
+		                                        std::to_string(expected.size()));
+		for (unsigned long i = 0; i < tokens.size() && i < expected.size(); i++) {
+			const Token &token = tokens[i];
+			bool same = token.getType() == expected[i].type && token.getValue() == expected[i].value &&
+			            token.getCoordinate().getLine() == expected[i].line &&
+			            token.getCoordinate().getColumn() == expected[i].column;
+			check(same, name + ": token " + std::to_string(i) + " (\"" + std::string(token.getValue()) +
+			            "\" instead of \"" + expected[i].value + "\")");
+			if (!same) break;
+		}
+	} catch (const Tokenizer::Exception &) {
+		failed = true;
+	}
+
+	bool expectedFailure = expected.back().type == Token::NONE;
+	check(failed == expectedFailure, name + (expectedFailure ? ": the invalid code is accepted" :
+	                                         ": the valid code is rejected"));
+	std::filesystem::remove(file);
+}
+
+/**
+ * Checks that a source holds the contents of it's file, and that the values of the tokens
+ * are views into those contents instead of copies.
+ */
+void checkSourceViews() {
+	std::string code = "qreg q[2];\ninclude \"qelib1.inc\";\nU(0.5, -pi) q[1];\n";
+	std::string file = writeFile("views", code);
+	{
+		Source source(file);
+		std::string_view contents = source.getCode();
+		check(contents == code, "views: the source differs from the file");
+		check(source.getFile() == Coordinate::intern(file), "views: the file isn't interned");
+
+		std::vector<Token> tokens = Tokenizer::tokenize(source);
+		for (const Token &token : tokens) {
+			if (token.getType() == Token::END) continue;
+			std::string_view value = token.getValue();
+			bool inside = value.data() >= contents.data() && value.data() + value.size() <= contents.data() + contents.size();
+			check(inside, "views: the value \"" + std::string(value) + "\" isn't a view into the source");
+			check(token.getCoordinate().getFile() == file, "views: the token has the wrong file");
+		}
+	}
+	std::filesystem::remove(file);
+
+	std::string empty = writeFile("empty", "");
+	{
+		Source source(empty);
+		check(source.getCode().empty(), "empty: the source isn't empty");
+		std::vector<Token> tokens = Tokenizer::tokenize(source);
+		check(tokens.size() == 1 && tokens[0].getType() == Token::END, "empty: the only token isn't the end");
+	}
+	std::filesystem::remove(empty);
+
+	bool thrown = false;
+	try {
+		Source source((std::filesystem::temp_directory_path() / "TokenizerTest_missing.qasm").string());
+	} catch (const std::runtime_error &) {
+		thrown = true;
+	}
+	check(thrown, "missing: a missing file is loaded");
+}
+
+int main() {
+	checkSameTokens("program",
+	                "OPENQASM 2.0;\n"
+	                "include \"qelib1.inc\";\n"
+	                "// A comment with symbols: ->, ==, \"quotes\" and keywords: gate if measure\n"
+	                "qreg q[16];\n"
+	                "creg c[16];\n"
+	                "gate rot(theta, phi) a, b {\n"
+	                "\tU(theta / 2, -phi * .25, (theta + phi) ^ 2) a;\n"
+	                "\tCX a,b;\n"
+	                "}\n"
+	                "opaque magic(alpha) a;\n"
+	                "rot(pi, -3.14159) q[0], q[15];\n"
+	                "barrier q;\n"
+	                "reset q[1];\n"
+	                "measure q[0] -> c[0];\n"
+	                "if(c==3) U(0,0,1.5) q[2];\n"
+	                "measure q -> c;\n");
+	checkSameTokens("names",
+	                "ifx measured gates creg2 _under reset_all barrier1 OPENQASMx includes;\n");
+	checkSameTokens("numbers",
+	                "U(0.5, 12, .125, 007, 1.0) q[10];\n");
+	checkSameTokens("operators",
+	                "a-b - c -> d==e;\n");
+	checkSameTokens("strings",
+	                "include \"a \\\"quoted\\\" name\";\ninclude \"\";\n");
+	checkSameTokens("line_endings",
+	                "qreg q[2];\r\ncreg c[2];\r\n\r\n  measure q -> c;\r\n");
+	checkSameTokens("comment_at_end",
+	                "qreg q[1];\n// the last line\n");
+	checkSameTokens("invalid_character",
+	                "qreg q[2];\ncreg c[2];\n  measure q $ c;\n");
+	checkSameTokens("invalid_number",
+	                "U(1e5) q;\n");
+	checkSourceViews();
+	return finish();
+}
@@ -0,0 +1,11 @@
+OPENQASM 2.0;
+qreg q[2];
+creg c[2];
+
+// q[1] stays in an equal superposition after q[0] is reset,
+// so the two outcomes must be drawn in every shot, not once
+U(pi/2, 0, pi) q[0];
+CX q[0], q[1];
+U(0, 0, pi/4) q[1];
+reset q[0];
+measure q -> c;